@@ -1,15 +1,60 @@
 #pragma once
 
+#include <span>
+
 #include "LZ77/LZLookupTable.hpp"
 
 class LZBase {
 public:
+  enum class Level {
+    Fast,   //!< Greedy matching over a few candidates, for quick iteration builds
+    Normal, //!< Greedy matching over the whole window, the classic output
+    Lazy,   //!< Defers a match by a byte when the next position has a longer one
+    Optimal //!< Picks the cheapest mix of literals and matches per segment, for shipping builds
+  };
+
   explicit LZBase(int32_t minimumOffset = 1, int32_t slidingWindow = 4096, int32_t minimumMatch = 3,
                   int32_t blockSize = 8);
   virtual ~LZBase();
 
-  virtual uint32_t compress(const uint8_t* src, uint8_t** dest, uint32_t srcLength) = 0;
-  virtual uint32_t decompress(const uint8_t* src, uint8_t** dest, uint32_t srcLength) = 0;
+  // Compress into a buffer allocated with new[], which the caller must delete[]
+  virtual uint32_t compress(const uint8_t* src, uint8_t** dest, uint32_t srcLength);
+  virtual uint32_t decompress(const uint8_t* src, uint8_t** dest, uint32_t srcLength);
+
+  /*! @brief Compresses src into dst, header and padding included, reusing this object's tables between calls.
+   *  @return The compressed size, or 0 when dst holds fewer than compressBound(src.size()) bytes
+   */
+  uint32_t compressInto(std::span<const uint8_t> src, std::span<uint8_t> dst);
+
+  /*! @brief Returns the most compressInto can write for srcLength bytes at the current level */
+  uint32_t compressBound(uint32_t srcLength) const;
+
+  /*! @brief Decompresses src into dst without allocating.
+   *  @return The decompressed size, or 0 when src is malformed or truncated, or dst is too small
+   */
+  virtual uint32_t decompressInto(std::span<const uint8_t> src, std::span<uint8_t> dst) const = 0;
+
+  /*! @brief Parses the header at the start of src
+   *  @return The header size, or 0 when src does not start with a header of this format
+   */
+  virtual uint32_t readHeader(std::span<const uint8_t> src, uint32_t& uncompressedSize) const = 0;
+
+  /*! @brief Compresses src[begin, end) as flag blocks, without the header or trailing padding.
+   *         Matches may reach back into the sliding window before begin, so consecutive ranges compressed
+   *         separately can be joined into one stream. The range gets its own lookup table, which makes
+   *         this safe to call on several threads at once. dst must hold at least
+   *         (end - begin) + (end - begin + 7) / 8 bytes.
+   *  @return The compressed size
+   */
+  uint32_t encodeRange(const uint8_t* src, uint32_t begin, uint32_t end, uint8_t* dst) const;
+
+  /*! @brief Writes the header for srcLength bytes of uncompressed data, at most 8 bytes
+   *  @return The header size
+   */
+  virtual uint32_t writeHeader(uint8_t* dst, uint32_t srcLength) const = 0;
+
+  /*! @brief Returns the size of the encoded match whose first byte is lead */
+  virtual uint32_t matchSize(uint8_t lead) const = 0;
 
   void setSlidingWindow(int32_t SlidingWindow);
   int32_t slidingWindow() const;
@@ -21,14 +66,44 @@ public:
   int32_t blockSize() const;
   void setMinimumOffset(uint32_t minimumOffset);
   uint32_t minimumOffset() const;
+  void setLevel(Level level);
+  Level level() const;
 
 protected:
   LZLengthOffset search(const uint8_t* posPtr, const uint8_t* dataBegin, const uint8_t* dataEnd) const;
+  virtual uint32_t encodeMatch(const LZLengthOffset& match, uint8_t* dst) const = 0;
+  // Size of the encoding encodeMatch picks for a match of the given length
+  virtual uint32_t encodedMatchSize(uint32_t length) const = 0;
+
 
   int32_t m_slidingWindow;
   int32_t m_readAheadBuffer;
   int32_t m_minMatch; // Minimum number of bytes that have to matched to go through with compression
   int32_t m_blockSize;
   uint32_t m_minOffset;
+  Level m_level = Level::Normal;
   LZLookupTable m_lookupTable;
+
+private:
+  // Parser output and working arrays, kept so repeated compression does not reallocate them
+  struct ParseScratch {
+    std::vector<LZLengthOffset> ops;
+    std::vector<LZLengthOffset> matches;
+    std::vector<uint32_t> cost;
+    std::vector<uint32_t> choice;
+  };
+
+  uint32_t encodeWith(LZLookupTable& table, ParseScratch& scratch, const uint8_t* src, uint32_t begin, uint32_t end,
+                      uint8_t* dst, bool endMarkers) const;
+
+  // Each parser appends the operations starting in [ptr, segEnd) to scratch.ops, a length below the minimum match
+  // being a literal, and returns where the next segment starts
+  const uint8_t* parseGreedy(LZLookupTable& table, ParseScratch& scratch, const uint8_t* dataBegin, const uint8_t* ptr,
+                             const uint8_t* segEnd, const uint8_t* dataEnd) const;
+  const uint8_t* parseLazy(LZLookupTable& table, ParseScratch& scratch, const uint8_t* dataBegin, const uint8_t* ptr,
+                           const uint8_t* segEnd, const uint8_t* dataEnd) const;
+  const uint8_t* parseOptimal(LZLookupTable& table, ParseScratch& scratch, const uint8_t* dataBegin,
+                              const uint8_t* ptr, const uint8_t* segEnd, const uint8_t* dataEnd) const;
+
+  ParseScratch m_scratch;
 };
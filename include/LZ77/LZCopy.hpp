@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+// Back-reference copies shared by the LZ10, LZ11 and Yaz0 decoders. A back-reference may overlap the bytes it
+// produces, so it has to behave as if copied one byte at a time; these do so with wide stores instead.
+
+// How far past the end of a run lzCopyMatch may write
+constexpr uint32_t LZCopySlack = 16;
+
+// Copies length bytes starting offset bytes behind out to out, one byte at a time. Safe right up to the buffer end.
+inline void lzCopyMatchExact(uint8_t* out, uint32_t offset, uint32_t length) {
+  const uint8_t* src = out - offset;
+  for (uint32_t i = 0; i < length; ++i)
+    out[i] = src[i];
+}
+
+// Copies length bytes starting offset bytes behind out to out, with the same result as lzCopyMatchExact.
+// Up to LZCopySlack bytes past out + length may be overwritten, the caller must have room for them.
+inline void lzCopyMatch(uint8_t* out, uint32_t offset, uint32_t length) {
+  if (offset == 1) {
+    // A run of a single byte
+    std::memset(out, out[-1], length);
+    return;
+  }
+
+  const uint8_t* src = out - offset;
+  uint8_t* const end = out + length;
+  if (offset >= 16) {
+    // Each store reads only bytes written before it
+    do {
+      std::memcpy(out, src, 16);
+      out += 16;
+      src += 16;
+    } while (out < end);
+    return;
+  }
+
+  if (offset < 8) {
+    // Lay down the first 8 bytes of the repeating pattern, then continue from the nearest whole period at
+    // least 8 bytes back so the 8 byte stores below never overlap their source
+    for (uint32_t i = 0; i < 8; ++i)
+      out[i] = src[i];
+    out += 8;
+    src = out - (8 + offset - 1) / offset * offset;
+    if (out >= end)
+      return;
+  }
+
+  do {
+    std::memcpy(out, src, 8);
+    out += 8;
+    src += 8;
+  } while (out < end);
+}
@@ -1,7 +1,6 @@
 #pragma once
 
 #include <cstdint>
-#include <map>
 #include <vector>
 #include <athena/Types.hpp>
 
@@ -12,19 +11,42 @@ struct LZLengthOffset {
   bool operator!=(const LZLengthOffset& lo_pair) const { return !operator==(lo_pair); }
 };
 
+// Hash chains over the positions in the sliding window. The head table holds the most recent position for each
+// hash of minimumMatch bytes and a ring the size of the window links every position to the previous one with the
+// same hash. Both are allocated on first use and reused by every later pass, so searching and inserting never
+// allocate.
 class LZLookupTable {
 public:
   LZLookupTable();
   explicit LZLookupTable(int32_t minimumMatch, int32_t slidingWindow = 4096, int32_t lookAheadWindow = 18);
   ~LZLookupTable();
+  // Finds the longest match for curPos, then inserts curPos and every position the match covers
   LZLengthOffset search(const uint8_t* curPos, const uint8_t* dataBegin, const uint8_t* dataEnd);
+
+  // For parsers that look at every position: find the longest match for curPos among the positions inserted so far,
+  // then insert curPos once it has been dealt with. A length below the minimum match means there is none.
+  LZLengthOffset find(const uint8_t* curPos, const uint8_t* dataBegin, const uint8_t* dataEnd) const;
+  void insert(const uint8_t* curPos, const uint8_t* dataBegin, const uint8_t* dataEnd);
+
   void setLookAheadWindow(int32_t lookAheadWindow);
+  // Stops searching after this many candidates, 0 searches the whole window
+  void setMaxChain(uint32_t maxChain);
 
 private:
-  using LookupTable = std::multimap<std::vector<uint8_t>, int32_t>;
-  LookupTable table;
+  void reset();
+  uint32_t hash(const uint8_t* pos) const;
+  void insert(const uint8_t* dataBegin, int32_t offset);
+  LZLengthOffset findMatch(const uint8_t* curPos, const uint8_t* dataBegin, const uint8_t* dataEnd,
+                           int32_t skipped) const;
+
+  static constexpr uint32_t HashBits = 13;
+
   int32_t m_minimumMatch = 3;
   int32_t m_slidingWindow = 4096;
   int32_t m_lookAheadWindow = 18;
-  std::vector<uint8_t> m_buffer;
+  uint32_t m_maxChain = UINT32_MAX;
+  std::vector<int32_t> m_head;
+  std::vector<int32_t> m_prev;
+  uint32_t m_prevMask = 0;
+  int32_t m_insertEnd = 0; // One past the most recently inserted offset
 };
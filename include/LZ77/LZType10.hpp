@@ -6,6 +6,12 @@ class LZType10 : public LZBase {
 public:
   explicit LZType10(int32_t minimumOffset = 1, int32_t SlidingWindow = 4096, int32_t MinimumMatch = 3,
                     int32_t BlockSize = 8);
-  uint32_t compress(const uint8_t* src, uint8_t** dstBuf, uint32_t srcLength) override;
-  uint32_t decompress(const uint8_t* src, uint8_t** dst, uint32_t srcLen) override;
+  uint32_t decompressInto(std::span<const uint8_t> src, std::span<uint8_t> dst) const override;
+  uint32_t readHeader(std::span<const uint8_t> src, uint32_t& uncompressedSize) const override;
+  uint32_t writeHeader(uint8_t* dst, uint32_t srcLength) const override;
+  uint32_t matchSize(uint8_t lead) const override;
+
+protected:
+  uint32_t encodeMatch(const LZLengthOffset& match, uint8_t* dst) const override;
+  uint32_t encodedMatchSize(uint32_t length) const override;
 };
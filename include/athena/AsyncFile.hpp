@@ -0,0 +1,284 @@
+#pragma once
+
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "athena/Global.hpp"
+#include "athena/Utility.hpp"
+
+namespace athena::io {
+class AsyncIOContext;
+
+/*! @brief A single positional read or write submitted to an AsyncIOContext.
+ *
+ *  Requests are normally created with AsyncFileReader::prepareReadAt / AsyncFileWriter::prepareWriteAt
+ *  and submitted in bulk with AsyncIOContext::submit. The request and its buffer must stay alive until
+ *  the submitting coroutine resumes.
+ */
+struct AsyncIORequest {
+  enum class Type { Read, Write };
+
+  Type type = Type::Read;
+  intptr_t handle = -1; //!< File descriptor, or HANDLE on Windows
+  uint64_t offset = 0;
+  void* buf = nullptr;
+  uint64_t len = 0;
+  int64_t result = 0; //!< Bytes transferred, or a negative error code once complete
+
+  // Bookkeeping owned by the context while the request is in flight
+  struct Batch {
+    std::coroutine_handle<> waiter;
+    size_t remaining = 0;
+  };
+  Batch* batch = nullptr;
+  AsyncIORequest* next = nullptr;
+  struct {
+    void* base;
+    size_t len;
+  } iov = {}; //!< Laid out as struct iovec for vectored kernel submission
+};
+
+/*! @brief Awaitable returned by AsyncFileReader::readAt / AsyncFileWriter::writeAt.
+ *         Resumes with the number of bytes transferred, or a negative error code.
+ */
+class AsyncIOOp {
+public:
+  AsyncIOOp(AsyncIOContext& ctx, const AsyncIORequest& req) : m_ctx(ctx), m_req(req) {}
+  bool await_ready() const { return m_req.handle == -1; }
+  void await_suspend(std::coroutine_handle<> waiter);
+  int64_t await_resume() const { return m_req.handle == -1 ? -1 : m_req.result; }
+
+private:
+  AsyncIOContext& m_ctx;
+  AsyncIORequest m_req;
+  AsyncIORequest::Batch m_batch;
+};
+
+/*! @brief Awaitable returned by AsyncIOContext::submit, resumes once every request in the batch completes.
+ *         Individual results are left in AsyncIORequest::result.
+ */
+class AsyncIOBatchOp {
+public:
+  AsyncIOBatchOp(AsyncIOContext& ctx, std::span<AsyncIORequest> reqs) : m_ctx(ctx), m_reqs(reqs) {}
+  bool await_ready() const { return m_reqs.empty(); }
+  void await_suspend(std::coroutine_handle<> waiter);
+  void await_resume() const {}
+
+private:
+  AsyncIOContext& m_ctx;
+  std::span<AsyncIORequest> m_reqs;
+  AsyncIORequest::Batch m_batch;
+};
+
+/*! @brief Minimal coroutine type for driving async file I/O.
+ *
+ *  The coroutine starts eagerly and runs until its first co_await, the rest of it runs from
+ *  AsyncIOContext::run or poll. The AsyncTask must outlive the coroutine; destroying it frees the frame.
+ */
+class AsyncTask {
+public:
+  struct promise_type {
+    AsyncTask get_return_object() { return AsyncTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+
+  AsyncTask(AsyncTask&& other) noexcept : m_handle(other.m_handle) { other.m_handle = nullptr; }
+  AsyncTask& operator=(AsyncTask&& other) noexcept {
+    std::swap(m_handle, other.m_handle);
+    return *this;
+  }
+  AsyncTask(const AsyncTask&) = delete;
+  AsyncTask& operator=(const AsyncTask&) = delete;
+  ~AsyncTask() {
+    if (m_handle)
+      m_handle.destroy();
+  }
+
+  bool done() const { return !m_handle || m_handle.done(); }
+
+private:
+  explicit AsyncTask(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+  std::coroutine_handle<promise_type> m_handle;
+};
+
+/*! @class AsyncIOContext
+ *  @brief Completion loop for asynchronous positional file I/O.
+ *
+ *  On Linux requests go to an io_uring instance, elsewhere (or if io_uring is unavailable at build or run
+ *  time) a small pool of worker threads performs them. In both cases coroutines are resumed only from run() or poll(),
+ *  on the calling thread, so many outstanding requests can be driven from a handful of threads.
+ *  A context is not thread-safe; use one per driving thread.
+ */
+class AsyncIOContext {
+public:
+  enum class Backend { Auto, IOUring, ThreadPool };
+
+  /*! @param backend The requested backend, Auto prefers io_uring where available
+   *  @param queueDepth Number of requests the kernel queue holds at once (io_uring only)
+   *  @param threadCount Number of worker threads (thread pool only)
+   */
+  explicit AsyncIOContext(Backend backend = Backend::Auto, uint32_t queueDepth = 256, uint32_t threadCount = 4);
+  ~AsyncIOContext();
+
+  AsyncIOContext(const AsyncIOContext&) = delete;
+  AsyncIOContext& operator=(const AsyncIOContext&) = delete;
+
+  /*! @brief Returns the backend actually in use, never Auto */
+  Backend backend() const;
+
+  /*! @brief Submits a batch of requests, the awaiting coroutine resumes once all of them complete */
+  AsyncIOBatchOp submit(std::span<AsyncIORequest> requests) { return {*this, requests}; }
+
+  /*! @brief Resumes coroutines as their requests complete until none are outstanding.
+   *
+   *  If the io_uring instance fails, queued requests complete with the negative error code. Requests already
+   *  with the kernel can then no longer be waited for, so their coroutines are abandoned.
+   */
+  void run();
+
+  /*! @brief Resumes coroutines whose requests have already completed, without blocking
+   *  @return The number of requests completed
+   */
+  size_t poll();
+
+  /*! @brief Returns the number of requests submitted but not yet completed */
+  size_t outstanding() const;
+
+private:
+  friend class AsyncIOOp;
+  friend class AsyncIOBatchOp;
+  void enqueue(AsyncIORequest& req);
+  size_t process(bool wait);
+
+  struct Impl;
+  std::unique_ptr<Impl> m_impl;
+};
+
+/*! @class AsyncFileReader
+ *  @brief A read-only file whose positional reads are co_await-able on an AsyncIOContext
+ *
+ *  There is no shared cursor; every read names its offset, so any number may be in flight at once.
+ *  @sa FileReader
+ */
+class AsyncFileReader {
+public:
+  AsyncFileReader(AsyncIOContext& ctx, std::string_view filename, bool globalErr = true);
+  AsyncFileReader(AsyncIOContext& ctx, std::wstring_view filename, bool globalErr = true);
+  ~AsyncFileReader();
+
+  AsyncFileReader(const AsyncFileReader&) = delete;
+  AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+
+  std::string filename() const {
+#if _WIN32
+    return utility::wideToUtf8(m_filename);
+#else
+    return m_filename;
+#endif
+  }
+
+  void open();
+  void close();
+  bool isOpen() const { return m_handle != -1; }
+  bool hasError() const { return m_hasError; }
+  uint64_t length() const { return m_length; }
+  AsyncIOContext& context() const { return m_ctx; }
+
+  /*! @brief Reads len bytes at offset into buf
+   *  @return Awaitable resuming with the number of bytes read, or a negative error code
+   */
+  AsyncIOOp readAt(uint64_t offset, void* buf, uint64_t len) { return {m_ctx, prepareReadAt(offset, buf, len)}; }
+
+  /*! @brief Describes a read for use with AsyncIOContext::submit */
+  AsyncIORequest prepareReadAt(uint64_t offset, void* buf, uint64_t len) const {
+    AsyncIORequest req;
+    req.type = AsyncIORequest::Type::Read;
+    req.handle = m_handle;
+    req.offset = offset;
+    req.buf = buf;
+    req.len = len;
+    return req;
+  }
+
+private:
+  AsyncIOContext& m_ctx;
+#if _WIN32
+  std::wstring m_filename;
+#else
+  std::string m_filename;
+#endif
+  intptr_t m_handle = -1;
+  uint64_t m_length = 0;
+  bool m_hasError = false;
+  bool m_globalErr;
+};
+
+/*! @class AsyncFileWriter
+ *  @brief A write-only file whose positional writes are co_await-able on an AsyncIOContext
+ *
+ *  Unlike FileWriter, writes go to the target file directly rather than to a temporary that is
+ *  renamed on close.
+ *  @sa FileWriter
+ */
+class AsyncFileWriter {
+public:
+  AsyncFileWriter(AsyncIOContext& ctx, std::string_view filename, bool overwrite = true, bool globalErr = true);
+  AsyncFileWriter(AsyncIOContext& ctx, std::wstring_view filename, bool overwrite = true, bool globalErr = true);
+  ~AsyncFileWriter();
+
+  AsyncFileWriter(const AsyncFileWriter&) = delete;
+  AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+  std::string filename() const {
+#if _WIN32
+    return utility::wideToUtf8(m_filename);
+#else
+    return m_filename;
+#endif
+  }
+
+  void open(bool overwrite = true);
+  void close();
+  bool isOpen() const { return m_handle != -1; }
+  bool hasError() const { return m_hasError; }
+  AsyncIOContext& context() const { return m_ctx; }
+
+  /*! @brief Writes len bytes from buf at offset
+   *  @return Awaitable resuming with the number of bytes written, or a negative error code
+   */
+  AsyncIOOp writeAt(uint64_t offset, const void* buf, uint64_t len) {
+    return {m_ctx, prepareWriteAt(offset, buf, len)};
+  }
+
+  /*! @brief Describes a write for use with AsyncIOContext::submit */
+  AsyncIORequest prepareWriteAt(uint64_t offset, const void* buf, uint64_t len) const {
+    AsyncIORequest req;
+    req.type = AsyncIORequest::Type::Write;
+    req.handle = m_handle;
+    req.offset = offset;
+    req.buf = const_cast<void*>(buf);
+    req.len = len;
+    return req;
+  }
+
+private:
+  AsyncIOContext& m_ctx;
+#if _WIN32
+  std::wstring m_filename;
+#else
+  std::string m_filename;
+#endif
+  intptr_t m_handle = -1;
+  bool m_hasError = false;
+  bool m_globalErr;
+};
+} // namespace athena::io
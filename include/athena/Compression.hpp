@@ -1,21 +1,252 @@
 #pragma once
 
+#include <memory>
+#include <span>
+#include <vector>
+
 #include "athena/Types.hpp"
+#include "LZ77/LZBase.hpp"
+
+struct z_stream_s;
 
 namespace athena::io::Compression {
 // Zlib compression
+/*! @brief Container around deflate data, shared by ZlibContext, ZlibStreamReader and ZlibStreamWriter */
+enum class ZlibFormat {
+  Auto, //!< Compress as Zlib, decompress either Zlib or Gzip as indicated by the header
+  Zlib,
+  Gzip,
+  Raw
+};
+
+/*! @brief Inflates zlib or gzip data, telling them apart by the header.
+ *  @return The decompressed size, or a negative zlib error code
+ */
 int32_t decompressZlib(const uint8_t* src, uint32_t srcLen, uint8_t* dst, uint32_t dstLen);
+/*! @brief Deflates src as zlib data at the best compression level.
+ *  @return The compressed size, or a negative zlib error code
+ */
 int32_t compressZlib(const uint8_t* src, uint32_t srcLen, uint8_t* dst, uint32_t dstLen);
 
+/*! @brief Reusable zlib compression and decompression context.
+ *
+ *  The deflate and inflate states are created on first use and only reset between payloads, so compressing or
+ *  decompressing many payloads does not reallocate zlib's window and hash tables. Changing the window bits or
+ *  format recreates the deflate state, changing the level or strategy keeps it with zlib 1.2.12 and later and
+ *  recreates it with older versions. One context per thread.
+ */
+class ZlibContext {
+public:
+  using Format = ZlibFormat;
+
+  /*! @brief Matches zlib's Z_DEFAULT_STRATEGY through Z_FIXED */
+  enum class Strategy { Default, Filtered, HuffmanOnly, Rle, Fixed };
+
+  /*! @param level Compression level from 0 to 9, -1 for zlib's default
+   *  @param format The container compress produces and decompress expects
+   *  @param strategy Tunes the match search for the kind of data being compressed
+   *  @param windowBits Base two log of the compression window, 9 to 15. Smaller windows use less memory while
+   *                    compressing, decompression always allows the full window
+   */
+  explicit ZlibContext(int32_t level = 9, Format format = Format::Auto, Strategy strategy = Strategy::Default,
+                       int32_t windowBits = 15);
+  ~ZlibContext();
+
+  ZlibContext(const ZlibContext&) = delete;
+  ZlibContext& operator=(const ZlibContext&) = delete;
+
+  void setLevel(int32_t level) { m_level = level; }
+  int32_t level() const { return m_level; }
+  void setFormat(Format format) { m_format = format; }
+  Format format() const { return m_format; }
+  void setStrategy(Strategy strategy) { m_strategy = strategy; }
+  Strategy strategy() const { return m_strategy; }
+  void setWindowBits(int32_t windowBits) { m_windowBits = windowBits; }
+  int32_t windowBits() const { return m_windowBits; }
+
+  /*! @brief Sets the preset dictionary used by every later compress and decompress, an empty one turns it off.
+   *
+   *  Priming deflate and inflate with data typical of the payloads lets matches start at the first byte, which
+   *  helps most for many small similar payloads, see trainZlibDictionary. Both sides need the same dictionary.
+   *  Zlib streams record its Adler-32 and fail to decompress with a different one, raw streams do not, and gzip
+   *  streams cannot use one. The data is copied.
+   */
+  void setDictionary(std::span<const uint8_t> dictionary) { m_dictionary.assign(dictionary.begin(), dictionary.end()); }
+  std::span<const uint8_t> dictionary() const { return m_dictionary; }
+
+  /*! @brief Compresses all of src into dst.
+   *  @return The compressed size, or a negative zlib error code, Z_BUF_ERROR when dst is too small
+   */
+  int32_t compress(std::span<const uint8_t> src, std::span<uint8_t> dst);
+
+  /*! @brief Decompresses one complete stream from src into dst.
+   *  @return The decompressed size, or a negative zlib error code, Z_BUF_ERROR when src is truncated or dst is
+   *          too small
+   */
+  int32_t decompress(std::span<const uint8_t> src, std::span<uint8_t> dst);
+
+  /*! @brief Returns the most compress can write for srcLen bytes with the current settings */
+  uint32_t compressBound(uint32_t srcLen);
+
+private:
+  bool prepareDeflate();
+  bool prepareInflate();
+
+  std::unique_ptr<z_stream_s> m_deflate;
+  std::unique_ptr<z_stream_s> m_inflate;
+  int32_t m_level;
+  Format m_format;
+  Strategy m_strategy;
+  int32_t m_windowBits;
+  std::vector<uint8_t> m_dictionary;
+
+  // Settings the live streams were last set up with, window bits of 0 meaning not initialized
+  int32_t m_deflateBits = 0;
+  int32_t m_deflateLevel = 0;
+  Strategy m_deflateStrategy = Strategy::Default;
+  int32_t m_inflateBits = 0;
+};
+
+/*! @brief Builds a preset dictionary of at most maxSize bytes for ZlibContext::setDictionary from sample payloads.
+ *
+ *  The corpus is split into one stretch per dictionary segment, and from each stretch the segment whose 8 byte
+ *  substrings occur in the most samples is taken, substrings already covered no longer counting. The most common
+ *  segments go last, where deflate reaches them with the shortest distances. Deflate only looks 32 KiB back, so
+ *  maxSize is capped there.
+ */
+std::vector<uint8_t> trainZlibDictionary(const std::vector<std::vector<uint8_t>>& samples, uint32_t maxSize = 0x8000);
+
+/*! @brief Deflates src on up to threadCount threads, 0 meaning one per hardware thread.
+ *
+ *  Large inputs are split into blocks that are deflated concurrently, each primed with the 32 KiB before it as a
+ *  dictionary and ended on a byte boundary with a sync flush. The blocks are joined under one header and a
+ *  checksum combined from the per-block ones, so the result is a single standard stream that decompressZlib or
+ *  any other inflater reads as usual. The flushes cost a few bytes per block. Small inputs, threadCount 1 and
+ *  platforms without threads compress exactly like ZlibContext.
+ *  @return The compressed size, or a negative zlib error code, Z_BUF_ERROR when dst is too small
+ */
+int32_t compressZlibParallel(const uint8_t* src, uint32_t srcLen, uint8_t* dst, uint32_t dstLen,
+                             uint32_t threadCount = 0, int32_t level = 9, ZlibFormat format = ZlibFormat::Zlib);
+
 #if AT_LZOKAY
 // lzo compression
 atInt32 decompressLZO(const atUint8* source, atInt32 sourceSize, atUint8* dst, atInt32& dstSize);
 #endif
 
 // Yaz0 encoding
+/*! @brief Decodes the Yaz0 payload in src, without the 16 byte header, into the uncompressedSize bytes at dst.
+ *  @return uncompressedSize, or 0 when src is truncated or references data before the start of dst
+ */
+uint32_t yaz0Decode(const uint8_t* src, uint32_t srcSize, uint8_t* dst, uint32_t uncompressedSize);
+// As above for callers that do not know the payload size, reads stop at the longest possible valid payload
 uint32_t yaz0Decode(const uint8_t* src, uint8_t* dst, uint32_t uncompressedSize);
 uint32_t yaz0Encode(const uint8_t* src, uint32_t srcSize, uint8_t* data);
 
+/*! @brief Returns the most yaz0Encode can write for srcSize bytes, not counting the 16 byte header */
+uint32_t yaz0EncodeBound(uint32_t srcSize);
+
+/*! @brief Reusable Yaz0 encoding context.
+ *
+ *  Matches are found through a hash chain over the 4 KiB window instead of a scan of every previous
+ *  position, and all state lives in the encoder, so one encoder per thread may run concurrently.
+ *  The match tables are kept between calls to avoid reallocating them.
+ */
+class Yaz0Encoder {
+public:
+  enum class Level {
+    Fast,    //!< Greedy matching over a short chain
+    Normal,  //!< Nintendo's one-step lookahead over a longer chain
+    Nintendo //!< Exhaustive search, output is bit-identical to Nintendo's encoder
+  };
+
+  explicit Yaz0Encoder(Level level = Level::Nintendo) : m_level(level) {}
+
+  void setLevel(Level level) { m_level = level; }
+  Level level() const { return m_level; }
+
+  /*! @brief Encodes srcSize bytes of src into dst, without the Yaz0 header.
+   *         dst must hold at least srcSize + (srcSize + 7) / 8 bytes.
+   *  @return The encoded size
+   */
+  uint32_t encode(const uint8_t* src, uint32_t srcSize, uint8_t* dst) { return encode(src, 0, srcSize, dst); }
+
+  /*! @brief Encodes src[begin, end) into dst, without the Yaz0 header.
+   *         Matches may reach back into the 4 KiB before begin, so consecutive ranges encoded separately,
+   *         possibly on different threads, can be joined into one stream.
+   *         dst must hold at least (end - begin) + (end - begin + 7) / 8 bytes.
+   *  @return The encoded size
+   */
+  uint32_t encode(const uint8_t* src, uint32_t begin, uint32_t end, uint8_t* dst);
+
+  /*! @brief Starts an incremental encode at position start of the caller's buffer, see nextOp. */
+  void reset(uint32_t start = 0);
+
+  /*! @brief Picks the operation at pos for incremental encoding, pos being just past the previous operation.
+   *         src[0, size) is the data available so far, matches reach back up to 4 KiB before pos. A match may
+   *         be longer than the format allows, the caller clamps it to 0x111 bytes.
+   *  @return The match length with matchPos set, or 1 for a literal
+   */
+  uint32_t nextOp(const uint8_t* src, uint32_t size, uint32_t pos, uint32_t& matchPos);
+
+  /*! @brief Tells the encoder the caller's buffer moved down by shift bytes, a multiple of 4 KiB that keeps the
+   *         4 KiB before the next position in the buffer.
+   */
+  void slide(uint32_t shift);
+
+private:
+  void insertUpTo(const uint8_t* src, uint32_t end);
+  uint32_t findMatch(const uint8_t* src, uint32_t size, uint32_t pos, uint32_t& matchPos);
+
+  Level m_level;
+  std::vector<int32_t> m_head;
+  std::vector<int32_t> m_prev;
+  std::vector<uint32_t> m_candidates;
+  uint32_t m_inserted = 0;
+  uint32_t m_insertEnd = 0;
+
+  // Lookahead result carried to the next position when it wins, see nextOp
+  bool m_haveNext = false;
+  uint32_t m_nextBytes = 0;
+  uint32_t m_nextMatchPos = 0;
+};
+
+/*! @brief Yaz0 encodes src on up to threadCount threads, 0 meaning one per hardware thread.
+ *
+ *  Large inputs are split into chunks that are encoded concurrently, each still matching against the
+ *  4 KiB before it, and joined into one stream that yaz0Decode reads like any other. Chunk boundaries
+ *  cut some matches short, so the output may be slightly larger than a single threaded encode.
+ *  Platforms without threads encode the chunks one after another.
+ */
+uint32_t yaz0Encode(const uint8_t* src, uint32_t srcSize, uint8_t* data, uint32_t threadCount,
+                    Yaz0Encoder::Level level = Yaz0Encoder::Level::Nintendo);
+
+/*! @brief Decompresses LZ10 or LZ11 data into a buffer allocated with new[], which the caller must delete[] */
 uint32_t decompressLZ77(const uint8_t* src, uint32_t srcLen, uint8_t** dst);
-uint32_t compressLZ77(const uint8_t* src, uint32_t srcLen, uint8_t** dst, bool extended = false);
+
+/*! @brief Returns the uncompressed size from an LZ10 or LZ11 header, or 0 when src holds neither */
+uint32_t decompressedLZ77Size(std::span<const uint8_t> src);
+
+/*! @brief Decompresses LZ10 or LZ11 data into dst without allocating.
+ *  @return The decompressed size, or 0 when src is malformed or dst is smaller than decompressedLZ77Size(src)
+ */
+uint32_t decompressLZ77Into(std::span<const uint8_t> src, std::span<uint8_t> dst);
+
+/*! @brief LZ77 compresses src as LZ10, or LZ11 when extended is set.
+ *         With threadCount other than 1, large inputs are compressed in chunks concurrently the same way as
+ *         the threaded yaz0Encode, 0 meaning one thread per hardware thread. level trades compression time
+ *         for size, Normal gives the classic greedy output.
+ */
+uint32_t compressLZ77(const uint8_t* src, uint32_t srcLen, uint8_t** dst, bool extended = false,
+                      uint32_t threadCount = 1, LZBase::Level level = LZBase::Level::Normal);
+
+/*! @brief Returns the most compressLZ77 can write for srcLen bytes in the given format and level */
+uint32_t compressLZ77Bound(uint32_t srcLen, bool extended = false, LZBase::Level level = LZBase::Level::Normal);
+
+/*! @brief Compresses src into dst without allocating once scratch is warmed up.
+ *
+ *  scratch is the encoder context, an LZType10 or LZType11 whose format and level are used and whose match tables
+ *  are kept between calls, so one context per thread can be reused for any number of payloads.
+ *  @return The compressed size, or 0 when dst is smaller than scratch.compressBound(src.size())
+ */
+uint32_t compressLZ77Into(std::span<const uint8_t> src, std::span<uint8_t> dst, LZBase& scratch);
 } // namespace athena::io::Compression
@@ -3,6 +3,7 @@
 #include <cstdio>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "athena/IStreamReader.hpp"
 #include "athena/Types.hpp"
@@ -37,9 +38,37 @@ public:
   uint64_t position() const override;
   uint64_t length() const override;
   uint64_t readUBytesToBuf(void* buf, uint64_t len) override;
+  uint64_t readScatter(std::span<const ScatterBuffer> bufs) override;
 
+  /** @brief Reads up to len bytes at offset without touching the stream position or the block cache.
+   *
+   *  The next sequential read continues where it would have without the call, cache enabled or not.
+   *  Safe to call from several threads at once on the same reader, as long as none of them
+   *  closes or reopens it. Where the platform read moves the OS file pointer (Win32 with the cache
+   *  disabled, and GEKKO/NX, which lack pread) the pointer is saved and restored around the read,
+   *  so there calls are not thread-safe.
+   *  @return The number of bytes read, short at the end of the file
+   */
+  uint64_t readAt(uint64_t offset, void* buf, uint64_t len) const;
+
+  /** @brief Sets the size of each cache block, a size of 0 disables the cache and reads go straight to the file.
+   *         Cached blocks are discarded. */
   void setCacheSize(const int32_t blockSize);
 
+  /** @brief Sets how many blocks the LRU cache holds at once. Cached blocks are discarded. */
+  void setCacheBlockCount(uint32_t blockCount);
+  int32_t cacheSize() const { return m_blockSize; }
+  uint32_t cacheBlockCount() const { return m_blockCount; }
+
+  /** @brief Enables adaptive readahead for the block cache.
+   *
+   *  Runs of consecutive block reads ask the OS to start fetching the blocks that follow, so disk
+   *  latency overlaps decoding. The window doubles on every sequential miss up to maxBlocks and
+   *  collapses as soon as access turns random. A maxBlocks of 0 (the default) disables readahead.
+   */
+  void setReadahead(uint32_t maxBlocks);
+  uint32_t readahead() const { return m_readaheadMax; }
+
 #if _WIN32
   using HandleType = void*;
 #else
@@ -48,17 +77,64 @@ public:
 
   HandleType _fileHandle() { return m_fileHandle; }
 
+  static constexpr uint32_t DefaultCacheBlockCount = 4;
+
 protected:
+  struct CacheBlock {
+    std::unique_ptr<uint8_t[]> data;
+    uint64_t index = UINT64_MAX; //!< Block number held, UINT64_MAX when empty
+    uint32_t length = 0;         //!< Valid bytes, short for the final block of the file
+    uint64_t lastUse = 0;
+  };
+
+  /** @brief Reads len bytes at offset, leaving the stream position where it was.
+   *         Implemented per platform (pread / overlapped ReadFile, restoring the file pointer when uncached).
+   *  @return The number of bytes read
+   */
+  uint64_t readFileAt(uint64_t offset, void* buf, uint64_t len) const;
+
+  /** @brief Vectored readFileAt, implemented per platform (preadv where available) */
+  uint64_t readFileAt(uint64_t offset, std::span<const ScatterBuffer> bufs) const;
+
+  /** @brief Hints the OS to start reading len bytes at offset in the background. Implemented per platform. */
+  void prefetchFileAt(uint64_t offset, uint64_t len) const;
+
+  /** @brief Records a read of blocks [first, last] and issues readahead if the pattern is sequential */
+  void trackReadahead(uint64_t first, uint64_t last);
+
+  /** @brief Returns the cache block holding block number index, reading it in over the least recently used
+   *         block if it is not resident. Returns nullptr on a failed read. */
+  CacheBlock* loadBlock(uint64_t index);
+  void resetCache();
+
+  void seekCached(int64_t pos, SeekOrigin origin);
+  uint64_t readCached(void* buf, uint64_t len);
+
+  /** @brief Folds the get area back into m_offset before the block cache is used directly */
+  void syncOffset() {
+    if (m_getBegin)
+      m_offset = m_getOffset + uint64_t(m_getCur - m_getBegin);
+  }
+
+  /** @brief Exposes the remainder of block at m_offset as the get area, or clears it if m_offset lies outside */
+  void updateGetArea(const CacheBlock* block);
+
 #if _WIN32
   std::wstring m_filename;
 #else
   std::string m_filename;
 #endif
   HandleType m_fileHandle;
-  uint64_t m_fileSize;
-  std::unique_ptr<uint8_t[]> m_cacheData;
-  int32_t m_blockSize;
-  int32_t m_curBlock;
+  uint64_t m_fileSize = 0;
+  std::vector<CacheBlock> m_cache;
+  int32_t m_blockSize = 0;
+  uint32_t m_blockCount = DefaultCacheBlockCount;
+  uint64_t m_useCounter = 0;
+  uint32_t m_readaheadMax = 0;
+  uint32_t m_readaheadWindow = 0;
+  uint64_t m_readaheadEnd = 0;        //!< First block past the last readahead hint
+  uint64_t m_lastBlock = UINT64_MAX; //!< Last block read from the file
+  uint64_t m_getOffset = 0; //!< File offset of m_getBegin
   uint64_t m_offset;
   bool m_globalErr;
 };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdio>
+#include <memory>
 
 #include "athena/IStreamWriter.hpp"
 #include "athena/Types.hpp"
@@ -31,9 +32,18 @@ public:
   void close();
   bool isOpen() const { return m_fileHandle != nullptr; }
   void seek(int64_t pos, SeekOrigin origin = SeekOrigin::Current) override;
-  uint64_t position() const override;
-  uint64_t length() const override;
+  uint64_t position() const override { return m_position; }
+  uint64_t length() const override { return m_length; }
   void writeUBytes(const uint8_t* data, uint64_t len) override;
+  void writeGather(std::span<const GatherBuffer> bufs) override;
+
+  /** @brief Writes any buffered bytes to the file */
+  void flush();
+
+  /** @brief Sets the size of the write-combining buffer, 0 writes every call straight through.
+   *         Buffered bytes are flushed first. */
+  void setBufferSize(size_t size);
+  size_t bufferSize() const { return m_bufferSize; }
 
 #ifdef _WIN32
   using HandleType = void*;
@@ -41,15 +51,32 @@ public:
   using HandleType = FILE*;
 #endif
 
+  /** @brief Returns the native handle, call flush() before writing through it */
   HandleType _fileHandle() { return m_fileHandle; }
 
+  static constexpr size_t DefaultBufferSize = 128 * 1024;
+
 private:
+  /* Platform primitives, operating on the OS file position */
+  bool writeRaw(const uint8_t* data, uint64_t len);
+  bool writeRawGather(std::span<const GatherBuffer> bufs);
+  bool seekRaw(uint64_t pos);
+
+  /* Moves the OS file position to m_position if it is elsewhere */
+  bool syncFilePos();
+
 #ifdef _WIN32
   std::wstring m_filename;
 #else
   std::string m_filename;
 #endif
   HandleType m_fileHandle;
+  std::unique_ptr<uint8_t[]> m_buffer;
+  size_t m_bufferSize = DefaultBufferSize;
+  size_t m_bufferLen = 0;   //!< Pending bytes, destined for [m_position - m_bufferLen, m_position)
+  uint64_t m_position = 0;
+  uint64_t m_length = 0;
+  uint64_t m_filePos = 0;   //!< Where the OS file position sits, UINT64_MAX if unknown
   bool m_globalErr;
 };
 
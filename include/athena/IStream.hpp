@@ -1,9 +1,23 @@
 #pragma once
 
+#include <memory_resource>
+
 #include "athena/Global.hpp"
 
 namespace athena::io {
 
+/** @brief One destination segment of IStreamReader::readScatter, laid out like struct iovec */
+struct ScatterBuffer {
+  void* data;
+  size_t len;
+};
+
+/** @brief One source segment of IStreamWriter::writeGather, laid out like struct iovec */
+struct GatherBuffer {
+  const void* data;
+  size_t len;
+};
+
 class IStream {
 public:
   virtual ~IStream() = default;
@@ -18,9 +32,18 @@ public:
   virtual uint64_t length() const = 0;
   bool hasError() const { return m_hasError; }
 
+  /** @brief Sets the resource that allocator-aware reads fall back on when no resource is passed,
+   *         nullptr restores std::pmr::get_default_resource()
+   */
+  void setMemoryResource(std::pmr::memory_resource* resource) { m_resource = resource; }
+  std::pmr::memory_resource* memoryResource() const {
+    return m_resource ? m_resource : std::pmr::get_default_resource();
+  }
+
 protected:
   void setError() { m_hasError = true; }
   bool m_hasError = false;
+  std::pmr::memory_resource* m_resource = nullptr;
 #if __BYTE_ORDER == __BIG_ENDIAN
   Endian m_endian = Endian::Big;
 #else
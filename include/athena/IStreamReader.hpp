@@ -1,7 +1,11 @@
 #pragma once
 
+#include <cstring>
 #include <functional>
 #include <memory>
+#include <memory_resource>
+#include <span>
+#include <string>
 #include <type_traits>
 #include <vector>
 
@@ -66,7 +70,7 @@ public:
    */
   int8_t readByte() {
     int8_t val = 0;
-    readUBytesToBuf(&val, 1);
+    readInline(&val, 1);
     return val;
   }
   template <class T>
@@ -120,6 +124,30 @@ public:
     return buf;
   }
 
+  /** @brief Reads a byte at the current position and advances the current position.
+   *
+   *  @param length   The number of bytes to read
+   *  @param resource The resource to allocate from, nullptr for memoryResource()
+   *  @return The buffer at the current position from the given length.
+   */
+  std::pmr::vector<int8_t> readBytes(uint64_t length, std::pmr::memory_resource* resource) {
+    std::pmr::vector<int8_t> buf(length, resource ? resource : memoryResource());
+    readUBytesToBuf(buf.data(), length);
+    return buf;
+  }
+
+  /** @brief Reads a byte at the current position and advances the current position.
+   *
+   *  @param length   The number of bytes to read
+   *  @param resource The resource to allocate from, nullptr for memoryResource()
+   *  @return The buffer at the current position from the given length.
+   */
+  std::pmr::vector<uint8_t> readUBytes(uint64_t length, std::pmr::memory_resource* resource) {
+    std::pmr::vector<uint8_t> buf(length, resource ? resource : memoryResource());
+    readUBytesToBuf(buf.data(), length);
+    return buf;
+  }
+
   /** @brief Attempts to read a fixed length of data into a pre-allocated buffer.
    *  @param buf The buffer to read into
    *  @param len The length of the buffer
@@ -135,6 +163,73 @@ public:
    */
   virtual uint64_t readUBytesToBuf(void* buf, uint64_t len) = 0;
 
+  /** @brief Reads consecutive bytes into several buffers in order, as if readUBytesToBuf were called on each.
+   *
+   *  Implementations backed by files override this to fill every segment with a single call.
+   *  @param bufs The segments to fill
+   *  @return The total number of bytes read, reading stops at the first short segment
+   */
+  virtual uint64_t readScatter(std::span<const ScatterBuffer> bufs) {
+    uint64_t total = 0;
+    for (const ScatterBuffer& buf : bufs) {
+      const uint64_t read = readUBytesToBuf(buf.data, buf.len);
+      total += read;
+      if (read != buf.len)
+        break;
+    }
+    return total;
+  }
+
+  /** @brief Returns a view of up to len bytes at the current position without advancing it.
+   *
+   *  Streams backed by addressable storage override this to point directly into that storage,
+   *  the view stays valid until the stream is re-targeted, closed or destroyed.
+   *  The default implementation returns an empty span, meaning views are not supported.
+   *  @param len The number of bytes to view
+   *  @return The viewed bytes, shorter than len if the end of the stream is reached
+   */
+  virtual std::span<const uint8_t> peekView(uint64_t /*len*/) { return {}; }
+
+  /** @brief Returns a view of len bytes at the current position and advances past them.
+   *  @param len The number of bytes to view
+   *  @return The viewed bytes, or an empty span if views are unsupported or fewer than len bytes remain.
+   */
+  std::span<const uint8_t> readView(uint64_t len) {
+    const std::span<const uint8_t> view = peekView(len);
+    if (view.size() != len)
+      return {};
+    seek(int64_t(len));
+    return view;
+  }
+
+  /** @brief Returns a view of len bytes at the current position and advances past them,
+   *         copying into scratch if the stream cannot provide a view.
+   *  @param len The number of bytes to view
+   *  @param scratch Storage used for the copying fallback, the returned span may point into it
+   *  @return The viewed bytes, shorter than len if the end of the stream is reached
+   */
+  std::span<const uint8_t> readView(uint64_t len, std::vector<uint8_t>& scratch) {
+    const std::span<const uint8_t> view = readView(len);
+    if (view.size() == len)
+      return view;
+    scratch.resize(len);
+    return {scratch.data(), size_t(readUBytesToBuf(scratch.data(), len))};
+  }
+
+  /** @brief Reads a numeric type T with its endianness fixed at compile time and advances the current position.
+   *
+   *  Unlike readVal, no runtime endian check is performed.
+   *  @return The value at the current address
+   */
+  template <class T, Endian E>
+  T readValAs(std::enable_if_t<std::is_arithmetic_v<T>>* = nullptr) {
+    T val{};
+    readInline(&val, sizeof(T));
+    if constexpr (E != utility::SystemEndian)
+      val = utility::swapValue(val);
+    return val;
+  }
+
   /** @brief Reads a Int16 and swaps to endianness specified by setEndian depending on platform
    *  and advances the current position
    *
@@ -142,7 +237,7 @@ public:
    */
   int16_t readInt16() {
     int16_t val = 0;
-    readUBytesToBuf(&val, 2);
+    readInline(&val, 2);
     return m_endian == Endian::Big ? utility::BigInt16(val) : utility::LittleInt16(val);
   }
   template <class T>
@@ -157,7 +252,7 @@ public:
    */
   int16_t readInt16Little() {
     int16_t val = 0;
-    readUBytesToBuf(&val, 2);
+    readInline(&val, 2);
     return utility::LittleInt16(val);
   }
   template <class T>
@@ -172,7 +267,7 @@ public:
    */
   int16_t readInt16Big() {
     int16_t val = 0;
-    readUBytesToBuf(&val, 2);
+    readInline(&val, 2);
     return utility::BigInt16(val);
   }
   template <class T>
@@ -198,7 +293,7 @@ public:
    */
   uint16_t readUint16Little() {
     uint16_t val = 0;
-    readUBytesToBuf(&val, 2);
+    readInline(&val, 2);
     return utility::LittleUint16(val);
   }
   template <class T>
@@ -213,7 +308,7 @@ public:
    */
   uint16_t readUint16Big() {
     uint16_t val = 0;
-    readUBytesToBuf(&val, 2);
+    readInline(&val, 2);
     return utility::BigUint16(val);
   }
   template <class T>
@@ -228,7 +323,7 @@ public:
    */
   int32_t readInt32() {
     int32_t val = 0;
-    readUBytesToBuf(&val, 4);
+    readInline(&val, 4);
     return m_endian == Endian::Big ? utility::BigInt32(val) : utility::LittleInt32(val);
   }
   template <class T>
@@ -243,7 +338,7 @@ public:
    */
   int32_t readInt32Little() {
     int32_t val = 0;
-    readUBytesToBuf(&val, 4);
+    readInline(&val, 4);
     return utility::LittleInt32(val);
   }
   template <class T>
@@ -258,7 +353,7 @@ public:
    */
   int32_t readInt32Big() {
     int32_t val = 0;
-    readUBytesToBuf(&val, 4);
+    readInline(&val, 4);
     return utility::BigInt32(val);
   }
   template <class T>
@@ -284,7 +379,7 @@ public:
    */
   uint32_t readUint32Little() {
     uint32_t val = 0;
-    readUBytesToBuf(&val, 4);
+    readInline(&val, 4);
     return utility::LittleUint32(val);
   }
   template <class T>
@@ -299,7 +394,7 @@ public:
    */
   uint32_t readUint32Big() {
     uint32_t val = 0;
-    readUBytesToBuf(&val, 4);
+    readInline(&val, 4);
     return utility::BigUint32(val);
   }
   template <class T>
@@ -314,7 +409,7 @@ public:
    */
   int64_t readInt64() {
     int64_t val = 0;
-    readUBytesToBuf(&val, 8);
+    readInline(&val, 8);
     return m_endian == Endian::Big ? utility::BigInt64(val) : utility::LittleInt64(val);
   }
   template <class T>
@@ -329,7 +424,7 @@ public:
    */
   int64_t readInt64Little() {
     int64_t val = 0;
-    readUBytesToBuf(&val, 8);
+    readInline(&val, 8);
     return utility::LittleInt64(val);
   }
   template <class T>
@@ -344,7 +439,7 @@ public:
    */
   int64_t readInt64Big() {
     int64_t val = 0;
-    readUBytesToBuf(&val, 8);
+    readInline(&val, 8);
     return utility::BigInt64(val);
   }
   template <class T>
@@ -370,7 +465,7 @@ public:
    */
   uint64_t readUint64Little() {
     uint64_t val = 0;
-    readUBytesToBuf(&val, 8);
+    readInline(&val, 8);
     return utility::LittleUint64(val);
   }
   template <class T>
@@ -385,7 +480,7 @@ public:
    */
   uint64_t readUint64Big() {
     uint64_t val = 0;
-    readUBytesToBuf(&val, 8);
+    readInline(&val, 8);
     return utility::BigUint64(val);
   }
   template <class T>
@@ -400,7 +495,7 @@ public:
    */
   float readFloat() {
     float val = 0.f;
-    readUBytesToBuf(&val, 4);
+    readInline(&val, 4);
     return m_endian == Endian::Big ? utility::BigFloat(val) : utility::LittleFloat(val);
   }
   template <class T>
@@ -415,7 +510,7 @@ public:
    */
   float readFloatLittle() {
     float val = 0.f;
-    readUBytesToBuf(&val, 4);
+    readInline(&val, 4);
     return utility::LittleFloat(val);
   }
   template <class T>
@@ -430,7 +525,7 @@ public:
    */
   float readFloatBig() {
     float val = 0.f;
-    readUBytesToBuf(&val, 4);
+    readInline(&val, 4);
     return utility::BigFloat(val);
   }
   template <class T>
@@ -445,7 +540,7 @@ public:
    */
   double readDouble() {
     double val = 0.0;
-    readUBytesToBuf(&val, 8);
+    readInline(&val, 8);
     return m_endian == Endian::Big ? utility::BigDouble(val) : utility::LittleDouble(val);
   }
   template <class T>
@@ -460,7 +555,7 @@ public:
    */
   double readDoubleLittle() {
     double val = 0.0;
-    readUBytesToBuf(&val, 8);
+    readInline(&val, 8);
     return utility::LittleDouble(val);
   }
   template <class T>
@@ -475,7 +570,7 @@ public:
    */
   double readDoubleBig() {
     double val = 0.0;
-    readUBytesToBuf(&val, 8);
+    readInline(&val, 8);
     return utility::BigDouble(val);
   }
   template <class T>
@@ -489,7 +584,7 @@ public:
    */
   bool readBool() {
     uint8_t val = false;
-    readUBytesToBuf(&val, 1);
+    readInline(&val, 1);
     return val != 0;
   }
   template <class T>
@@ -512,7 +607,7 @@ public:
    */
   atVec2f readVec2f() {
     simd_floats val = {};
-    readUBytesToBuf(val.data(), 8);
+    readInline(val.data(), 8);
     if (m_endian == Endian::Big) {
       val[0] = utility::BigFloat(val[0]);
       val[1] = utility::BigFloat(val[1]);
@@ -538,7 +633,7 @@ public:
    */
   atVec2f readVec2fLittle() {
     simd_floats val = {};
-    readUBytesToBuf(val.data(), 8);
+    readInline(val.data(), 8);
     val[0] = utility::LittleFloat(val[0]);
     val[1] = utility::LittleFloat(val[1]);
     val[2] = 0.f;
@@ -559,7 +654,7 @@ public:
    */
   atVec2f readVec2fBig() {
     simd_floats val = {};
-    readUBytesToBuf(val.data(), 8);
+    readInline(val.data(), 8);
     val[0] = utility::BigFloat(val[0]);
     val[1] = utility::BigFloat(val[1]);
     val[2] = 0.f;
@@ -580,7 +675,7 @@ public:
    */
   atVec3f readVec3f() {
     simd_floats val = {};
-    readUBytesToBuf(val.data(), 12);
+    readInline(val.data(), 12);
     if (m_endian == Endian::Big) {
       val[0] = utility::BigFloat(val[0]);
       val[1] = utility::BigFloat(val[1]);
@@ -607,7 +702,7 @@ public:
    */
   atVec3f readVec3fLittle() {
     simd_floats val = {};
-    readUBytesToBuf(val.data(), 12);
+    readInline(val.data(), 12);
     val[0] = utility::LittleFloat(val[0]);
     val[1] = utility::LittleFloat(val[1]);
     val[2] = utility::LittleFloat(val[2]);
@@ -628,7 +723,7 @@ public:
    */
   atVec3f readVec3fBig() {
     simd_floats val = {};
-    readUBytesToBuf(val.data(), 12);
+    readInline(val.data(), 12);
     val[0] = utility::BigFloat(val[0]);
     val[1] = utility::BigFloat(val[1]);
     val[2] = utility::BigFloat(val[2]);
@@ -649,7 +744,7 @@ public:
    */
   atVec4f readVec4f() {
     simd_floats val = {};
-    readUBytesToBuf(val.data(), 16);
+    readInline(val.data(), 16);
     if (m_endian == Endian::Big) {
       val[0] = utility::BigFloat(val[0]);
       val[1] = utility::BigFloat(val[1]);
@@ -677,7 +772,7 @@ public:
    */
   atVec4f readVec4fLittle() {
     simd_floats val = {};
-    readUBytesToBuf(val.data(), 16);
+    readInline(val.data(), 16);
     val[0] = utility::LittleFloat(val[0]);
     val[1] = utility::LittleFloat(val[1]);
     val[2] = utility::LittleFloat(val[2]);
@@ -698,7 +793,7 @@ public:
    */
   atVec4f readVec4fBig() {
     simd_floats val = {};
-    readUBytesToBuf(val.data(), 16);
+    readInline(val.data(), 16);
     val[0] = utility::BigFloat(val[0]);
     val[1] = utility::BigFloat(val[1]);
     val[2] = utility::BigFloat(val[2]);
@@ -719,7 +814,7 @@ public:
    */
   atVec2d readVec2d() {
     simd_doubles val = {};
-    readUBytesToBuf(val.data(), 16);
+    readInline(val.data(), 16);
     if (m_endian == Endian::Big) {
       val[0] = utility::BigDouble(val[0]);
       val[1] = utility::BigDouble(val[1]);
@@ -745,7 +840,7 @@ public:
    */
   atVec2d readVec2dLittle() {
     simd_doubles val = {};
-    readUBytesToBuf(val.data(), 16);
+    readInline(val.data(), 16);
     val[0] = utility::LittleDouble(val[0]);
     val[1] = utility::LittleDouble(val[1]);
     val[2] = 0.0;
@@ -766,7 +861,7 @@ public:
    */
   atVec2d readVec2dBig() {
     simd_doubles val = {};
-    readUBytesToBuf(val.data(), 16);
+    readInline(val.data(), 16);
     val[0] = utility::BigDouble(val[0]);
     val[1] = utility::BigDouble(val[1]);
     val[2] = 0.0;
@@ -787,7 +882,7 @@ public:
    */
   atVec3d readVec3d() {
     simd_doubles val = {};
-    readUBytesToBuf(val.data(), 24);
+    readInline(val.data(), 24);
     if (m_endian == Endian::Big) {
       val[0] = utility::BigDouble(val[0]);
       val[1] = utility::BigDouble(val[1]);
@@ -814,7 +909,7 @@ public:
    */
   atVec3d readVec3dLittle() {
     simd_doubles val = {};
-    readUBytesToBuf(val.data(), 24);
+    readInline(val.data(), 24);
     val[0] = utility::LittleDouble(val[0]);
     val[1] = utility::LittleDouble(val[1]);
     val[2] = utility::LittleDouble(val[2]);
@@ -835,7 +930,7 @@ public:
    */
   atVec3d readVec3dBig() {
     simd_doubles val = {};
-    readUBytesToBuf(val.data(), 24);
+    readInline(val.data(), 24);
     val[0] = utility::BigDouble(val[0]);
     val[1] = utility::BigDouble(val[1]);
     val[2] = utility::BigDouble(val[2]);
@@ -856,7 +951,7 @@ public:
    */
   atVec4d readVec4d() {
     simd_doubles val = {};
-    readUBytesToBuf(val.data(), 32);
+    readInline(val.data(), 32);
     if (m_endian == Endian::Big) {
       val[0] = utility::BigDouble(val[0]);
       val[1] = utility::BigDouble(val[1]);
@@ -884,7 +979,7 @@ public:
    */
   atVec4d readVec4dLittle() {
     simd_doubles val = {};
-    readUBytesToBuf(val.data(), 32);
+    readInline(val.data(), 32);
     val[0] = utility::LittleDouble(val[0]);
     val[1] = utility::LittleDouble(val[1]);
     val[2] = utility::LittleDouble(val[2]);
@@ -905,7 +1000,7 @@ public:
    */
   atVec4d readVec4dBig() {
     simd_doubles val = {};
-    readUBytesToBuf(val.data(), 32);
+    readInline(val.data(), 32);
     val[0] = utility::BigDouble(val[0]);
     val[1] = utility::BigDouble(val[1]);
     val[2] = utility::BigDouble(val[2]);
@@ -953,6 +1048,37 @@ public:
     return readString();
   }
 
+  /** @brief Reads a string allocated from the given resource and advances the position in the file
+   *
+   *  @param resource The resource to allocate from, nullptr for memoryResource()
+   *  @param fixedLen If non-negative, this is a fixed-length string read.
+   *  @param doSeek   Whether or not to reset the advanced position of the file.
+   *                  This is ignored if fixedLen is less than or equal to zero.
+   *
+   *  @return The read string
+   */
+  std::pmr::string readString(std::pmr::memory_resource* resource, int32_t fixedLen = -1, bool doSeek = true) {
+    std::pmr::string ret(resource ? resource : memoryResource());
+    if (fixedLen == 0)
+      return ret;
+    uint8_t chr = readByte();
+
+    int32_t i;
+    for (i = 1; chr != 0; ++i) {
+      ret += chr;
+
+      if (fixedLen > 0 && i >= fixedLen)
+        break;
+
+      chr = readByte();
+    }
+
+    if (doSeek && fixedLen > 0 && i < fixedLen)
+      seek(fixedLen - i);
+
+    return ret;
+  }
+
   /** @brief Reads a wstring and advances the position in the file
    *
    *  @param fixedLen If non-negative, this is a fixed-length string read.
@@ -1129,6 +1255,43 @@ public:
     return readU32StringBig();
   }
 
+  /** @brief Reads a contiguous array of numeric type T in a single transfer and swaps it in place
+   *         to the endianness specified by setEndian
+   *
+   *  @param out The elements to populate
+   *  @return The number of whole elements read
+   */
+  template <class T>
+  size_t readArray(std::span<T> out, std::enable_if_t<std::is_arithmetic_v<T>>* = nullptr) {
+    return m_endian == Endian::Big ? readArrayBig(out) : readArrayLittle(out);
+  }
+
+  /** @brief Reads a contiguous array of numeric type T in a single transfer and swaps it in place
+   *         against little endianness depending on platform
+   *
+   *  @param out The elements to populate
+   *  @return The number of whole elements read
+   */
+  template <class T>
+  size_t readArrayLittle(std::span<T> out, std::enable_if_t<std::is_arithmetic_v<T>>* = nullptr) {
+    const size_t count = size_t(readUBytesToBuf(out.data(), out.size_bytes()) / sizeof(T));
+    utility::LittleArray(out.data(), count);
+    return count;
+  }
+
+  /** @brief Reads a contiguous array of numeric type T in a single transfer and swaps it in place
+   *         against big endianness depending on platform
+   *
+   *  @param out The elements to populate
+   *  @return The number of whole elements read
+   */
+  template <class T>
+  size_t readArrayBig(std::span<T> out, std::enable_if_t<std::is_arithmetic_v<T>>* = nullptr) {
+    const size_t count = size_t(readUBytesToBuf(out.data(), out.size_bytes()) / sizeof(T));
+    utility::BigArray(out.data(), count);
+    return count;
+  }
+
   /** @brief Performs automatic std::vector enumeration reads using numeric type T
    *
    *  @param vector The std::vector to clear and populate using read data
@@ -1136,14 +1299,19 @@ public:
    *
    *  Endianness is set with setEndian
    */
-  template <class T>
-  void enumerate(std::vector<T>& vector, size_t count,
+  template <class T, class Alloc>
+  void enumerate(std::vector<T, Alloc>& vector, size_t count,
                  std::enable_if_t<std::is_arithmetic_v<T> || std::is_same_v<T, atVec2f> || std::is_same_v<T, atVec3f> ||
                                   std::is_same_v<T, atVec4f>>* = nullptr) {
     vector.clear();
-    vector.reserve(count);
-    for (size_t i = 0; i < count; ++i)
-      vector.push_back(readVal<T>());
+    if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) {
+      vector.resize(count);
+      readArray(std::span<T>(vector));
+    } else {
+      vector.reserve(count);
+      for (size_t i = 0; i < count; ++i)
+        vector.push_back(readVal<T>());
+    }
   }
 
   /** @brief Performs automatic std::vector enumeration reads using numeric type T
@@ -1153,14 +1321,19 @@ public:
    *
    *  Endianness is little
    */
-  template <class T>
-  void enumerateLittle(std::vector<T>& vector, size_t count,
+  template <class T, class Alloc>
+  void enumerateLittle(std::vector<T, Alloc>& vector, size_t count,
                        std::enable_if_t<std::is_arithmetic_v<T> || std::is_same_v<T, atVec2f> ||
                                         std::is_same_v<T, atVec3f> || std::is_same_v<T, atVec4f>>* = nullptr) {
     vector.clear();
-    vector.reserve(count);
-    for (size_t i = 0; i < count; ++i)
-      vector.push_back(readValLittle<T>());
+    if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) {
+      vector.resize(count);
+      readArrayLittle(std::span<T>(vector));
+    } else {
+      vector.reserve(count);
+      for (size_t i = 0; i < count; ++i)
+        vector.push_back(readValLittle<T>());
+    }
   }
 
   /** @brief Performs automatic std::vector enumeration reads using numeric type T
@@ -1170,14 +1343,19 @@ public:
    *
    *  Endianness is big
    */
-  template <class T>
-  void enumerateBig(std::vector<T>& vector, size_t count,
+  template <class T, class Alloc>
+  void enumerateBig(std::vector<T, Alloc>& vector, size_t count,
                     std::enable_if_t<std::is_arithmetic_v<T> || std::is_same_v<T, atVec2f> ||
                                      std::is_same_v<T, atVec3f> || std::is_same_v<T, atVec4f>>* = nullptr) {
     vector.clear();
-    vector.reserve(count);
-    for (size_t i = 0; i < count; ++i)
-      vector.push_back(readValBig<T>());
+    if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) {
+      vector.resize(count);
+      readArrayBig(std::span<T>(vector));
+    } else {
+      vector.reserve(count);
+      for (size_t i = 0; i < count; ++i)
+        vector.push_back(readValBig<T>());
+    }
   }
 
   /** @brief Performs automatic std::vector enumeration reads using non-numeric type T
@@ -1185,8 +1363,8 @@ public:
    *  @param vector The std::vector to clear and populate using read data
    *  @param count The number of elements to read into vector
    */
-  template <class T>
-  void enumerate(std::vector<T>& vector, size_t count,
+  template <class T, class Alloc>
+  void enumerate(std::vector<T, Alloc>& vector, size_t count,
                  std::enable_if_t<!std::is_arithmetic_v<T> && !std::is_same_v<T, atVec2f> &&
                                   !std::is_same_v<T, atVec3f> && !std::is_same_v<T, atVec4f>>* = nullptr) {
     vector.clear();
@@ -1204,8 +1382,8 @@ public:
    *  @param readf Function (e.g. a lambda) that reads *one* element and
    *               assigns the value through the second argument
    */
-  template <class T>
-  void enumerate(std::vector<T>& vector, size_t count, std::function<void(IStreamReader&, T&)> readf) {
+  template <class T, class Alloc>
+  void enumerate(std::vector<T, Alloc>& vector, size_t count, std::function<void(IStreamReader&, T&)> readf) {
     vector.clear();
     vector.reserve(count);
     for (size_t i = 0; i < count; ++i) {
@@ -1213,6 +1391,34 @@ public:
       readf(*this, vector.back());
     }
   }
+
+protected:
+  /** @brief Sets the get area, a window of buffered stream bytes that primitive reads consume inline.
+   *
+   *  cur corresponds to position(); implementations must move it on seek and re-establish or clear
+   *  the window whenever readUBytesToBuf runs, since that is where reads land once the window is exhausted.
+   *  Implementations that never set a get area always take the readUBytesToBuf path.
+   */
+  void setGetArea(const uint8_t* begin, const uint8_t* cur, const uint8_t* end) {
+    m_getBegin = begin;
+    m_getCur = cur;
+    m_getEnd = end;
+  }
+  void clearGetArea() { setGetArea(nullptr, nullptr, nullptr); }
+
+  /** @brief Copies len bytes from the get area if it holds enough, otherwise defers to readUBytesToBuf */
+  void readInline(void* buf, size_t len) {
+    if (size_t(m_getEnd - m_getCur) >= len) {
+      std::memcpy(buf, m_getCur, len);
+      m_getCur += len;
+      return;
+    }
+    readUBytesToBuf(buf, len);
+  }
+
+  const uint8_t* m_getBegin = nullptr;
+  const uint8_t* m_getCur = nullptr;
+  const uint8_t* m_getEnd = nullptr;
 };
 template <typename T>
 IStreamReader& operator>>(IStreamReader& lhs, T& rhs) {
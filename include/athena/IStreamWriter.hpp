@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
+#include <span>
 #include <string>
 #include <type_traits>
 #include <vector>
@@ -77,6 +80,16 @@ public:
    */
   virtual void writeUBytes(const uint8_t* data, uint64_t length) = 0;
 
+  /** @brief Writes several buffers back to back, as if writeUBytes were called on each.
+   *
+   *  Implementations backed by files override this to write every segment with a single call.
+   *  @param bufs The segments to write
+   */
+  virtual void writeGather(std::span<const GatherBuffer> bufs) {
+    for (const GatherBuffer& buf : bufs)
+      writeUBytes(static_cast<const uint8_t*>(buf.data), buf.len);
+  }
+
   /** @brief Writes the given buffer with the specified length, buffers can be bigger than the length
    *  however it's undefined behavior to try and write a buffer which is smaller than the given length.
    *
@@ -994,17 +1007,60 @@ public:
 
   void fill(int8_t val, uint64_t length) { fill((uint8_t)val, length); }
 
+  /** @brief Writes a contiguous array of numeric type T in as few transfers as possible.
+   *         It also swaps the bytes depending on the platform and Stream settings.
+   *
+   *  @param in The elements to write
+   */
+  template <class T>
+  void writeArray(std::span<const T> in, std::enable_if_t<std::is_arithmetic_v<T>>* = nullptr) {
+    if (m_endian == Endian::Big)
+      writeArrayBig(in);
+    else
+      writeArrayLittle(in);
+  }
+
+  /** @brief Writes a contiguous array of numeric type T in as few transfers as possible.
+   *         It also swaps the bytes against little depending on the platform.
+   *
+   *  @param in The elements to write
+   */
+  template <class T>
+  void writeArrayLittle(std::span<const T> in, std::enable_if_t<std::is_arithmetic_v<T>>* = nullptr) {
+    if constexpr (utility::isSystemBigEndian() && sizeof(T) > 1)
+      writeArraySwapped(in);
+    else
+      writeUBytes(reinterpret_cast<const uint8_t*>(in.data()), in.size_bytes());
+  }
+
+  /** @brief Writes a contiguous array of numeric type T in as few transfers as possible.
+   *         It also swaps the bytes against big depending on the platform.
+   *
+   *  @param in The elements to write
+   */
+  template <class T>
+  void writeArrayBig(std::span<const T> in, std::enable_if_t<std::is_arithmetic_v<T>>* = nullptr) {
+    if constexpr (!utility::isSystemBigEndian() && sizeof(T) > 1)
+      writeArraySwapped(in);
+    else
+      writeUBytes(reinterpret_cast<const uint8_t*>(in.data()), in.size_bytes());
+  }
+
   /** @brief Performs automatic std::vector enumeration writes using numeric type T
    *  @param vector The std::vector read from when writing data
    *
    *  Endianness is set with setEndian
    */
-  template <class T>
-  void enumerate(const std::vector<T>& vector,
+  template <class T, class Alloc>
+  void enumerate(const std::vector<T, Alloc>& vector,
                  std::enable_if_t<std::is_arithmetic_v<T> || std::is_same_v<T, atVec2f> || std::is_same_v<T, atVec3f> ||
                                   std::is_same_v<T, atVec4f>>* = nullptr) {
-    for (const T& item : vector)
-      writeVal(item);
+    if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) {
+      writeArray(std::span<const T>(vector));
+    } else {
+      for (const T& item : vector)
+        writeVal(item);
+    }
   }
 
   /** @brief Performs automatic std::vector enumeration writes using numeric type T
@@ -1012,12 +1068,16 @@ public:
    *
    *  Endianness is little
    */
-  template <class T>
-  void enumerateLittle(const std::vector<T>& vector,
+  template <class T, class Alloc>
+  void enumerateLittle(const std::vector<T, Alloc>& vector,
                        std::enable_if_t<std::is_arithmetic_v<T> || std::is_same_v<T, atVec2f> ||
                                         std::is_same_v<T, atVec3f> || std::is_same_v<T, atVec4f>>* = nullptr) {
-    for (const T& item : vector)
-      writeValLittle(item);
+    if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) {
+      writeArrayLittle(std::span<const T>(vector));
+    } else {
+      for (const T& item : vector)
+        writeValLittle(item);
+    }
   }
 
   /** @brief Performs automatic std::vector enumeration writes using numeric type T
@@ -1025,24 +1085,42 @@ public:
    *
    *  Endianness is big
    */
-  template <class T>
-  void enumerateBig(const std::vector<T>& vector,
+  template <class T, class Alloc>
+  void enumerateBig(const std::vector<T, Alloc>& vector,
                     std::enable_if_t<std::is_arithmetic_v<T> || std::is_same_v<T, atVec2f> ||
                                      std::is_same_v<T, atVec3f> || std::is_same_v<T, atVec4f>>* = nullptr) {
-    for (const T& item : vector)
-      writeValBig(item);
+    if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) {
+      writeArrayBig(std::span<const T>(vector));
+    } else {
+      for (const T& item : vector)
+        writeValBig(item);
+    }
   }
 
   /** @brief Performs automatic std::vector enumeration writes using non-numeric type T
    *  @param vector The std::vector read from when writing data
    */
-  template <class T>
-  void enumerate(const std::vector<T>& vector,
+  template <class T, class Alloc>
+  void enumerate(const std::vector<T, Alloc>& vector,
                  std::enable_if_t<!std::is_arithmetic_v<T> && !std::is_same_v<T, atVec2f> &&
                                   !std::is_same_v<T, atVec3f> && !std::is_same_v<T, atVec4f>>* = nullptr) {
     for (const T& item : vector)
       item.write(*this);
   }
+
+private:
+  template <class T>
+  void writeArraySwapped(std::span<const T> in) {
+    // Swap through a fixed stack buffer so no allocation is needed and the source stays untouched
+    constexpr size_t ChunkElems = 4096 / sizeof(T);
+    T tmp[ChunkElems];
+    for (size_t i = 0; i < in.size(); i += ChunkElems) {
+      const size_t count = std::min(ChunkElems, in.size() - i);
+      std::memcpy(tmp, in.data() + i, count * sizeof(T));
+      utility::swapArray(tmp, count);
+      writeUBytes(reinterpret_cast<const uint8_t*>(tmp), count * sizeof(T));
+    }
+  }
 };
 
 template <typename T>
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <string>
+
+#include "athena/IStreamReader.hpp"
+#include "athena/Types.hpp"
+
+namespace athena::io {
+/*! @class MappedFileReader
+ *  @brief A read-only Stream class that maps an entire file into memory
+ *
+ *  Unlike FileReader, no block cache or stdio calls are involved; every read is served
+ *  directly from the mapping. This is best suited for large inputs that are opened read-only.
+ *  @sa FileReader
+ */
+class MappedFileReader : public IStreamReader {
+public:
+  /*! @brief Access pattern hint passed to the OS for the mapped range */
+  enum class Advice { Normal, Sequential, Random, WillNeed };
+
+  explicit MappedFileReader(std::string_view filename, Advice advice = Advice::Normal, bool globalErr = true);
+  explicit MappedFileReader(std::wstring_view filename, Advice advice = Advice::Normal, bool globalErr = true);
+  ~MappedFileReader() override;
+
+  MappedFileReader(const MappedFileReader&) = delete;
+  MappedFileReader& operator=(const MappedFileReader&) = delete;
+
+  std::string filename() const {
+#if _WIN32
+    return utility::wideToUtf8(m_filename);
+#else
+    return m_filename;
+#endif
+  }
+
+  std::wstring wfilename() const {
+#if _WIN32
+    return m_filename;
+#else
+    return utility::utf8ToWide(m_filename);
+#endif
+  }
+
+  void open();
+  void close();
+  bool isOpen() const { return m_isOpen; }
+
+  /*! @brief Changes the access pattern hint for the mapping.
+   *
+   *  Sequential favors aggressive readahead, Random disables it and WillNeed
+   *  asks the OS to start paging the whole file in immediately.
+   */
+  void setAdvice(Advice advice);
+  Advice advice() const { return m_advice; }
+
+  void seek(int64_t pos, SeekOrigin origin = SeekOrigin::Current) override;
+  uint64_t position() const override { return uint64_t(m_getCur - m_getBegin); }
+  uint64_t length() const override { return m_length; }
+  uint64_t readUBytesToBuf(void* buf, uint64_t len) override;
+  std::span<const uint8_t> peekView(uint64_t len) override;
+
+  /*! @brief Copies up to len bytes at offset without touching the stream position.
+   *         Safe to call concurrently as long as the reader is not closed.
+   *  @return The number of bytes read, short at the end of the file
+   */
+  uint64_t readAt(uint64_t offset, void* buf, uint64_t len) const;
+
+  /*! @brief Returns the start of the mapping, or nullptr if the file is not open or empty.
+   *         The pointer is valid until the reader is closed or destroyed.
+   */
+  const uint8_t* data() const { return m_data; }
+
+  /*! @brief Borrows len bytes at the current position and advances past them.
+   *
+   *  No copy is made; the returned pointer aliases the mapping and remains valid
+   *  until the reader is closed or destroyed.
+   *  @param len The number of bytes to borrow
+   *  @return Pointer into the mapping, or nullptr if fewer than len bytes remain
+   */
+  const uint8_t* borrowUBytes(uint64_t len);
+
+protected:
+#if _WIN32
+  std::wstring m_filename;
+  void* m_fileHandle = nullptr;
+  void* m_mappingHandle = nullptr;
+#else
+  std::string m_filename;
+  int m_fd = -1;
+#endif
+  const uint8_t* m_data = nullptr;
+  uint64_t m_length = 0;
+  Advice m_advice;
+  bool m_isOpen = false;
+  bool m_globalErr;
+};
+} // namespace athena::io
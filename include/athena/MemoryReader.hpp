@@ -30,6 +30,15 @@ public:
    */
   explicit MemoryReader(const void* data, uint64_t length, bool takeOwnership = false, bool globalErr = true);
 
+  /*! \brief This constructor adopts an existing buffer to read from.
+   *
+   *   \param data      The buffer to adopt, freed with the reader.
+   *   \param length    The length of the buffer.
+   *   \param globalErr Whether or not global errors are enabled.
+   */
+  MemoryReader(std::unique_ptr<uint8_t[]> data, uint64_t length, bool globalErr = true)
+  : MemoryReader(data.release(), length, true, globalErr) {}
+
   /*! \brief Sets the buffers position relative to the specified position.<br />
    *         It seeks relative to the current position by default.
    *  \param position where in the buffer to seek
@@ -41,7 +50,7 @@ public:
    *
    *  \return Int64 The current position in the stream.
    */
-  uint64_t position() const override { return m_position; }
+  uint64_t position() const override { return uint64_t(m_getCur - m_getBegin); }
 
   /*! \brief Returns whether or not the stream is at the end.
    *
@@ -77,10 +86,34 @@ public:
    */
   uint64_t readUBytesToBuf(void* buf, uint64_t len) override;
 
+  /*! \brief Reads consecutive bytes into several user-allocated buffers
+   *  \param bufs The segments to fill
+   *  \return Total number of bytes read
+   */
+  uint64_t readScatter(std::span<const ScatterBuffer> bufs) override;
+
+  /*! \brief Copies up to len bytes at offset without touching the stream position,
+   *         safe to call concurrently as long as the buffer is not replaced
+   *  \param offset Offset into the buffer to read from
+   *  \param buf User-allocated buffer pointer
+   *  \param len Length to read
+   *  \return Number of bytes read, short at the end of the buffer
+   */
+  uint64_t readAt(uint64_t offset, void* buf, uint64_t len) const;
+
+  /*! \brief Returns a view into the buffer at the current position without copying
+   *  \param len Length to view
+   *  \return The viewed bytes, shorter than len at the end of the buffer
+   */
+  std::span<const uint8_t> peekView(uint64_t len) override;
+
 protected:
+  /*! \brief Points the get area at the whole buffer, the position lives in it from then on */
+  void resetGetArea(uint64_t position = 0);
+  void setPosition(uint64_t position) { m_getCur = m_getBegin + position; }
+
   const void* m_data = nullptr;
   uint64_t m_length = 0;
-  uint64_t m_position = 0;
   bool m_owns = false;
   bool m_globalErr = true;
 };
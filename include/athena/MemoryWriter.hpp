@@ -28,6 +28,14 @@ public:
    */
   explicit MemoryWriter(uint8_t* data, uint64_t length, bool takeOwnership = false);
 
+  /*! @brief This constructor adopts an existing buffer to write to in-place.
+   *
+   *   @param data   The buffer to adopt, freed with the writer.
+   *   @param length The length of the buffer.
+   */
+  MemoryWriter(std::unique_ptr<uint8_t[]> data, uint64_t length)
+  : MemoryWriter(data.release(), length, true) {}
+
   /*! @brief Sets the buffers position relative to the specified position.<br />
    *         It seeks relative to the current position by default.
    *  @param position where in the buffer to seek
@@ -63,6 +71,13 @@ public:
    */
   uint8_t* data() const;
 
+  /*! @brief Detaches the buffer from the writer without copying it.<br />
+   *         If the writer owned the buffer the caller now does and must delete[] it.
+   *         The writer is left empty.
+   *  @return Uint8* The buffer, length() bytes long before the call.
+   */
+  virtual uint8_t* release();
+
   /*! @brief Sets the target file
    *
    *  @param filepath The path to write to.
@@ -113,6 +128,13 @@ public:
    */
   explicit MemoryCopyWriter(std::string_view filename);
 
+  /*! @brief This constructor adopts an existing buffer instead of copying it.
+   *
+   *   @param data The buffer to adopt
+   *   @param length The length of the buffer
+   */
+  MemoryCopyWriter(std::unique_ptr<uint8_t[]> data, uint64_t length);
+
   /*! @brief Sets the buffers position relative to the specified position.<br />
    *         It seeks relative to the current position by default.
    *  @param position where in the buffer to seek
@@ -139,11 +161,49 @@ public:
    */
   void writeUBytes(const uint8_t* data, uint64_t length) override;
 
+  /*! @brief Writes several buffers back to back, growing the buffer at most once
+   *
+   * @param bufs The segments to write
+   */
+  void writeGather(std::span<const GatherBuffer> bufs) override;
+
+  /*! @brief Ensures the buffer can hold at least capacity bytes without reallocating.
+   *         The logical length is unchanged.
+   *
+   * @param capacity The number of bytes to reserve
+   */
+  void reserve(uint64_t capacity);
+
+  /*! @brief Releases any spare capacity beyond the logical length */
+  void shrinkToFit();
+
+  /*! @brief Returns the number of bytes the buffer can hold before it has to grow
+   *
+   * @return The current capacity
+   */
+  uint64_t capacity() const { return m_capacity; }
+
+  /*! @brief Moves the buffer out of the writer without copying it, leaving the writer empty.<br />
+   *         Only the first length() bytes are meaningful, query it before the call.
+   *
+   * @return The buffer
+   */
+  std::unique_ptr<uint8_t[]> takeBuffer();
+
+  /*! @brief Same as takeBuffer(), the caller must delete[] the returned buffer
+   *
+   * @return Uint8* The buffer
+   */
+  uint8_t* release() override { return takeBuffer().release(); }
+
 protected:
   std::unique_ptr<uint8_t[]> m_dataCopy;
+  uint64_t m_capacity = 0;
 
 private:
   void resize(uint64_t newSize);
+  void grow(uint64_t minCapacity);
+  void reallocate(uint64_t capacity);
 };
 
 } // namespace athena::io
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <memory>
+#include <span>
+
+#include "athena/IStreamReader.hpp"
+
+namespace athena::io {
+/*! @class SubStreamReader
+ *  @brief A read-only window of [offset, offset + length) over a buffer or another stream
+ *
+ *  The window has its own cursor starting at 0, reads past its end behave like the end of a stream.
+ *  Windows over a buffer read from it in place without copying. Windows over a parent stream seek
+ *  the parent for each read and put its position back afterwards, so the parent and any number of
+ *  windows over it can be used in turn; the parent must outlive the window.
+ *  @sa MemoryReader
+ */
+class SubStreamReader : public IStreamReader {
+public:
+  /*! @brief Creates a window over a buffer that must outlive the reader.
+   *
+   *  @param data The bytes to expose
+   *  @param globalErr Whether or not global errors are enabled
+   */
+  explicit SubStreamReader(std::span<const uint8_t> data, bool globalErr = true);
+
+  /*! @brief Creates a window over a shared buffer, keeping it alive for as long as the reader.
+   *
+   *  @param data The buffer
+   *  @param offset Start of the window within data
+   *  @param length Length of the window
+   *  @param globalErr Whether or not global errors are enabled
+   */
+  SubStreamReader(std::shared_ptr<const uint8_t[]> data, uint64_t offset, uint64_t length, bool globalErr = true);
+
+  /*! @brief Creates a window over part of another stream, inheriting its endianness.
+   *
+   *  @param parent The stream to read from
+   *  @param offset Start of the window within parent
+   *  @param length Length of the window
+   *  @param globalErr Whether or not global errors are enabled
+   */
+  SubStreamReader(IStreamReader& parent, uint64_t offset, uint64_t length, bool globalErr = true);
+
+  void seek(int64_t pos, SeekOrigin origin = SeekOrigin::Current) override;
+  uint64_t position() const override { return m_parent ? m_position : uint64_t(m_getCur - m_getBegin); }
+  uint64_t length() const override { return m_length; }
+  uint64_t readUBytesToBuf(void* buf, uint64_t len) override;
+  std::span<const uint8_t> peekView(uint64_t len) override;
+
+  /*! @brief Returns where the window starts in its parent stream or buffer */
+  uint64_t offset() const { return m_offset; }
+
+  /*! @brief Returns the window's bytes for buffer-backed windows, or an empty span for stream-backed ones */
+  std::span<const uint8_t> view() const { return {m_data, size_t(m_parent ? 0 : m_length)}; }
+
+protected:
+  void setPosition(uint64_t pos);
+
+  IStreamReader* m_parent = nullptr;        //!< Set for windows over a stream
+  const uint8_t* m_data = nullptr;          //!< Start of the window for windows over a buffer
+  std::shared_ptr<const uint8_t[]> m_owner; //!< Keeps a shared buffer alive
+  uint64_t m_offset = 0;
+  uint64_t m_length = 0;
+  uint64_t m_position = 0; //!< Cursor of windows over a stream, buffer windows keep it in the get area
+  bool m_globalErr;
+};
+} // namespace athena::io
@@ -4,6 +4,7 @@
 #include <cstring>
 #include <string>
 #include <string_view>
+#include <type_traits>
 #include <vector>
 
 #include "athena/Global.hpp"
@@ -175,6 +176,50 @@ BSWAP_CONSTEXPR double BigDouble(double val) {
   return val;
 }
 
+/** @brief Byte-swaps a single value of any numeric type. */
+template <typename T>
+BSWAP_CONSTEXPR T swapValue(T val) {
+  static_assert(std::is_arithmetic_v<T>, "swapValue requires a numeric type");
+  if constexpr (std::is_same_v<T, float>)
+    return swapFloat(val);
+  else if constexpr (std::is_same_v<T, double>)
+    return swapDouble(val);
+  else if constexpr (sizeof(T) == 2)
+    return T(swapU16(uint16_t(val)));
+  else if constexpr (sizeof(T) == 4)
+    return T(swapU32(uint32_t(val)));
+  else if constexpr (sizeof(T) == 8)
+    return T(swapU64(uint64_t(val)));
+  else
+    return val;
+}
+
+/** @brief Byte-swaps count elements in place, using SSSE3/AVX2/NEON shuffles where available. */
+void swapArrayU16(uint16_t* data, size_t count);
+void swapArrayU32(uint32_t* data, size_t count);
+void swapArrayU64(uint64_t* data, size_t count);
+
+template <typename T>
+void swapArray(T* data, size_t count) {
+  static_assert(std::is_arithmetic_v<T>, "swapArray requires a numeric type");
+  if constexpr (sizeof(T) == 2)
+    swapArrayU16(reinterpret_cast<uint16_t*>(data), count);
+  else if constexpr (sizeof(T) == 4)
+    swapArrayU32(reinterpret_cast<uint32_t*>(data), count);
+  else if constexpr (sizeof(T) == 8)
+    swapArrayU64(reinterpret_cast<uint64_t*>(data), count);
+}
+template <typename T>
+void BigArray(T* data, size_t count) {
+  if constexpr (!athena::utility::isSystemBigEndian())
+    swapArray(data, count);
+}
+template <typename T>
+void LittleArray(T* data, size_t count) {
+  if constexpr (athena::utility::isSystemBigEndian())
+    swapArray(data, count);
+}
+
 void fillRandom(uint8_t* rndArea, uint64_t count);
 std::vector<std::string> split(std::string_view s, char delim);
 uint64_t rand64();
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstdint>
+#include <memory_resource>
+#include <utility>
 #include <vector>
 
 #include "athena/IStreamWriter.hpp"
@@ -8,15 +10,31 @@
 
 namespace athena::io {
 
-/*! @class VectorWriter
+/*! @class BasicVectorWriter
  *  @brief A Stream class for writing data to a STL vector
  *
  *  A Class for writing binary data to an STL vector,
- *  all work is done using a std::vector, and not written directly to the disk
+ *  all work is done using a std::vector, and not written directly to the disk.
+ *  Use VectorWriter for the default allocator or PmrVectorWriter to grow the vector from a memory resource.
  *  @sa Stream
  */
-class VectorWriter : public IStreamWriter {
+template <class Allocator>
+class BasicVectorWriter : public IStreamWriter {
 public:
+  using vector_type = std::vector<uint8_t, Allocator>;
+
+  BasicVectorWriter() = default;
+
+  /*! @brief Creates an empty writer whose vector allocates through alloc
+   *  @param alloc The allocator, or for PmrVectorWriter a std::pmr::memory_resource*
+   */
+  explicit BasicVectorWriter(const Allocator& alloc) : m_data(alloc) {}
+
+  /*! @brief Adopts an existing vector, writing starts at its beginning
+   *  @param data The vector to take over
+   */
+  explicit BasicVectorWriter(vector_type&& data) : m_data(std::move(data)) {}
+
   /*! @brief Sets the buffers position relative to the specified position.<br />
    *         It seeks relative to the current position by default.
    *  @param position where in the buffer to seek
@@ -39,7 +57,13 @@ public:
   bool isOpen() const { return true; }
 
   /*! @brief Obtains reference to underlying std::vector store */
-  const std::vector<uint8_t>& data() const { return m_data; }
+  const vector_type& data() const { return m_data; }
+
+  /*! @brief Moves the underlying std::vector out of the writer, leaving it empty */
+  vector_type takeBuffer() {
+    m_position = 0;
+    return std::exchange(m_data, vector_type(m_data.get_allocator()));
+  }
 
   /*! @brief Writes the given buffer with the specified length, buffers can be bigger than the length
    *  however it's undefined behavior to try and write a buffer which is smaller than the given length.
@@ -50,9 +74,30 @@ public:
    */
   void writeUBytes(const uint8_t* data, uint64_t length) override;
 
+  /*! @brief Writes several buffers back to back, growing the vector at most once
+   *
+   * @param bufs The segments to write
+   */
+  void writeGather(std::span<const GatherBuffer> bufs) override;
+
 protected:
-  std::vector<uint8_t> m_data;
+  vector_type m_data;
   uint64_t m_position = 0;
 };
 
+extern template class BasicVectorWriter<std::allocator<uint8_t>>;
+extern template class BasicVectorWriter<std::pmr::polymorphic_allocator<uint8_t>>;
+
+/*! @class VectorWriter
+ *  @brief BasicVectorWriter over a std::vector with the default allocator
+ *
+ *  A class of its own rather than an alias, so it can still be forward declared as one.
+ */
+class VectorWriter : public BasicVectorWriter<std::allocator<uint8_t>> {
+public:
+  using BasicVectorWriter::BasicVectorWriter;
+};
+
+using PmrVectorWriter = BasicVectorWriter<std::pmr::polymorphic_allocator<uint8_t>>;
+
 } // namespace athena::io
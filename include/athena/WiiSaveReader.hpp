@@ -42,7 +42,7 @@ public:
 private:
   WiiBanner* readBanner();
   WiiFile* readFile();
-  WiiImage* readImage(uint32_t width, uint32_t height);
+  WiiImage* readImage(IStreamReader& in, uint32_t width, uint32_t height);
   void readCerts(uint32_t totalSize);
   WiiFile* buildTree(std::vector<WiiFile*> files);
 };
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <memory>
+
+#include "athena/IStreamReader.hpp"
+
+namespace athena::io {
+/*! @class Yaz0Reader
+ *  @brief A read-only Stream that decodes Yaz0 data on demand from another reader
+ *
+ *  The 16 byte Yaz0 header is parsed from the source on construction, after which output is decoded a
+ *  chunk at a time behind a 4 KiB history window, so memory use is bounded regardless of the payload size.
+ *  Malformed input (truncated data or back-references before the start of the output) is reported as an
+ *  error rather than read out of bounds. Seeking forward decodes and discards, seeking backward restarts
+ *  from the beginning of the payload. The source must outlive the reader.
+ *  @sa Yaz0Writer
+ */
+class Yaz0Reader : public IStreamReader {
+public:
+  static constexpr uint32_t DefaultChunkSize = 16 * 1024;
+
+  /*! @brief Reads the Yaz0 header at the current position of source.
+   *
+   *  @param source The reader holding the Yaz0 data
+   *  @param chunkSize The amount of output decoded at once
+   *  @param globalErr Whether or not global errors are enabled
+   */
+  explicit Yaz0Reader(IStreamReader& source, uint32_t chunkSize = DefaultChunkSize, bool globalErr = true);
+
+  Yaz0Reader(const Yaz0Reader&) = delete;
+  Yaz0Reader& operator=(const Yaz0Reader&) = delete;
+
+  void seek(int64_t pos, SeekOrigin origin = SeekOrigin::Current) override;
+  uint64_t position() const override { return m_outOffset + uint64_t(m_getCur - m_getBegin); }
+
+  /*! @brief Returns the uncompressed size stored in the Yaz0 header */
+  uint64_t length() const override { return m_length; }
+
+  uint64_t readUBytesToBuf(void* buf, uint64_t len) override;
+
+  /*! @brief Decodes ahead as needed so the view covers len bytes unless the payload ends first.
+   *         A view longer than the chunk size grows the output buffer to hold it.
+   */
+  std::span<const uint8_t> peekView(uint64_t len) override;
+
+  /*! @brief Rewinds to the start of the payload */
+  void reset();
+
+private:
+  bool nextIn(uint8_t& val);
+  uint64_t decodeChunk(uint64_t want);
+  void skip(uint64_t count);
+  void fail(const char* msg);
+
+  static constexpr uint32_t WindowSize = 0x1000;
+  static constexpr uint32_t InputSize = 0x1000;
+
+  IStreamReader& m_source;
+  std::unique_ptr<uint8_t[]> m_out; //!< WindowSize bytes of history, a chunk of output and copy slack
+  uint8_t m_in[InputSize];
+  uint32_t m_inPos = 0;
+  uint32_t m_inLen = 0;
+  uint32_t m_chunkSize;
+  uint64_t m_outCapacity; //!< Size of m_out, not counting the copy slack
+  uint64_t m_dataStart = 0;
+  uint64_t m_outOffset = 0; //!< Decompressed offset of the start of the get area
+  uint64_t m_produced = 0;  //!< Decompressed bytes decoded so far
+  uint64_t m_length = 0;
+
+  // Decoder state carried between chunks
+  uint32_t m_copyDist = 0;
+  uint32_t m_copyLen = 0;
+  uint8_t m_code = 0;
+  uint8_t m_codeBits = 0;
+  bool m_failed = false;
+  bool m_globalErr;
+};
+} // namespace athena::io
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <memory>
+
+#include "athena/Compression.hpp"
+#include "athena/IStreamWriter.hpp"
+
+namespace athena::io {
+/*! @class Yaz0Writer
+ *  @brief A write-only Stream that Yaz0 encodes everything written to it into another writer
+ *
+ *  The Yaz0 header is written to the sink up front. Input is encoded as it arrives by a
+ *  Compression::Yaz0Encoder at the Nintendo level, keeping only the match window plus a bounded amount
+ *  of pending input in memory. Matches only see the input buffered so far, so inputs with runs longer
+ *  than 0x111 bytes may encode slightly differently from yaz0Encode while decoding to the same data.
+ *  The stream is only complete once finish() has been called, which the destructor does if needed.
+ *  The sink must outlive the writer.
+ *  @sa Yaz0Reader
+ */
+class Yaz0Writer : public IStreamWriter {
+public:
+  /*! @brief Writes the Yaz0 header at the current position of sink.
+   *
+   *  @param sink The writer receiving Yaz0 data
+   *  @param uncompressedSize The total that will be written, or UINT32_MAX to patch the header on finish(),
+   *                          which requires sink to be able to seek back
+   *  @param globalErr Whether or not global errors are enabled
+   */
+  explicit Yaz0Writer(IStreamWriter& sink, uint32_t uncompressedSize = UINT32_MAX, bool globalErr = true);
+  ~Yaz0Writer() override;
+
+  Yaz0Writer(const Yaz0Writer&) = delete;
+  Yaz0Writer& operator=(const Yaz0Writer&) = delete;
+
+  /*! @brief Only forward seeks are possible, the skipped range is written as zeros */
+  void seek(int64_t pos, SeekOrigin origin = SeekOrigin::Current) override;
+  uint64_t position() const override { return m_position; }
+  uint64_t length() const override { return m_position; }
+  void writeUBytes(const uint8_t* data, uint64_t len) override;
+
+  /*! @brief Encodes any pending input and completes the stream, further writes are errors */
+  void finish();
+
+  bool finished() const { return m_finished; }
+
+private:
+  void encode(bool final);
+  void emitLiteral(uint8_t val);
+  void emitMatch(uint32_t len, uint32_t dist);
+  void flushGroup();
+
+  static constexpr uint32_t WindowSize = 0x1000;
+  static constexpr uint32_t MaxMatch = 0xFF + 0x12;
+  static constexpr uint32_t BufferSize = WindowSize + 0x10000;
+
+  IStreamWriter& m_sink;
+  std::unique_ptr<uint8_t[]> m_buf; //!< Match window followed by input that is not encoded yet
+  uint32_t m_encPos = 0;
+  uint32_t m_bufEnd = 0;
+  uint8_t m_group[1 + 8 * 3]; //!< Code byte followed by up to eight encoded operations
+  uint32_t m_groupLen = 1;
+  uint32_t m_groupOps = 0;
+  uint64_t m_headerPos;
+  uint64_t m_position = 0;
+  uint32_t m_expectedSize;
+  Compression::Yaz0Encoder m_encoder;
+
+  bool m_finished = false;
+  bool m_globalErr;
+};
+} // namespace athena::io
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <memory>
+
+#include "athena/Compression.hpp"
+#include "athena/IStreamReader.hpp"
+
+struct z_stream_s;
+
+namespace athena::io {
+/*! @class ZlibStreamReader
+ *  @brief A read-only Stream that inflates zlib, gzip or raw deflate data on demand from another reader
+ *
+ *  Compressed input is pulled from the source in fixed-size chunks and inflated into an output chunk
+ *  that primitive reads are served from, so memory use stays constant however large the payload is.
+ *  Reads of at least a chunk inflate straight into the caller's buffer.
+ *  Seeking forward inflates and discards, seeking backward restarts from the beginning of the payload.
+ *  The source must outlive the reader and is left just past the compressed data once the end is reached.
+ *  @sa ZlibStreamWriter
+ */
+class ZlibStreamReader : public IStreamReader {
+public:
+  /*! @brief Container around the deflate data, Auto accepts zlib or gzip */
+  using Format = Compression::ZlibFormat;
+
+  static constexpr uint32_t DefaultChunkSize = 64 * 1024;
+
+  /*! @brief Starts inflating at the current position of source.
+   *
+   *  @param source The reader holding the compressed data
+   *  @param format The container format to expect
+   *  @param chunkSize The size of each of the input and output chunks
+   *  @param globalErr Whether or not global errors are enabled
+   */
+  explicit ZlibStreamReader(IStreamReader& source, Format format = Format::Auto,
+                            uint32_t chunkSize = DefaultChunkSize, bool globalErr = true);
+  ~ZlibStreamReader() override;
+
+  ZlibStreamReader(const ZlibStreamReader&) = delete;
+  ZlibStreamReader& operator=(const ZlibStreamReader&) = delete;
+
+  void seek(int64_t pos, SeekOrigin origin = SeekOrigin::Current) override;
+  uint64_t position() const override { return m_outOffset + uint64_t(m_getCur - m_getBegin); }
+
+  /*! @brief Returns the decompressed length.
+   *
+   *  The length is only known once the end of the compressed data has been reached (or after
+   *  setUncompressedLength), before that this returns UINT64_MAX.
+   */
+  uint64_t length() const override { return m_length; }
+
+  /*! @brief Tells the reader how large the payload is, for formats that store it in their own header */
+  void setUncompressedLength(uint64_t length) { m_length = length; }
+
+  uint64_t readUBytesToBuf(void* buf, uint64_t len) override;
+
+  /*! @brief Inflates ahead as needed so the view covers len bytes unless the stream ends first.
+   *         A view longer than the chunk size grows the output buffer to hold it.
+   */
+  std::span<const uint8_t> peekView(uint64_t len) override;
+
+  /*! @brief Rewinds to the start of the compressed data, reusing the inflate state */
+  void reset();
+
+  /*! @brief Returns whether the end of the compressed data has been reached */
+  bool finished() const { return m_finished; }
+
+private:
+  uint64_t inflateInto(uint8_t* dst, uint64_t len);
+  uint64_t fillChunk(uint64_t want);
+  void skip(uint64_t count);
+
+  IStreamReader& m_source;
+  std::unique_ptr<z_stream_s> m_strm;
+  std::unique_ptr<uint8_t[]> m_in;
+  std::unique_ptr<uint8_t[]> m_out;
+  uint32_t m_chunkSize;
+  uint64_t m_outCapacity; //!< Size of m_out, at least m_chunkSize
+  uint64_t m_sourceStart;
+  uint64_t m_outOffset = 0; //!< Decompressed offset of the start of the get area
+  uint64_t m_produced = 0;  //!< Decompressed bytes inflated so far
+  uint64_t m_length = UINT64_MAX;
+  Format m_format;
+  bool m_initialized = false;
+  bool m_finished = false;
+  bool m_globalErr;
+};
+} // namespace athena::io
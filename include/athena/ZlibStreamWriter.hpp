@@ -0,0 +1,74 @@
+#pragma once
+
+#include <memory>
+
+#include "athena/Compression.hpp"
+#include "athena/IStreamWriter.hpp"
+
+struct z_stream_s;
+
+namespace athena::io {
+/*! @class ZlibStreamWriter
+ *  @brief A write-only Stream that deflates everything written to it into another writer
+ *
+ *  Small writes are collected into an input chunk before being deflated, large ones are deflated
+ *  in place, and compressed output goes to the sink a chunk at a time. The stream is only complete
+ *  once finish() has been called, which the destructor does if needed. The sink must outlive the writer.
+ *  @sa ZlibStreamReader
+ */
+class ZlibStreamWriter : public IStreamWriter {
+public:
+  /*! @brief Container to wrap the deflate data in, Auto writes Zlib */
+  using Format = Compression::ZlibFormat;
+
+  static constexpr uint32_t DefaultChunkSize = 64 * 1024;
+
+  /*! @brief Starts a compressed stream at the current position of sink.
+   *
+   *  @param sink The writer receiving compressed data
+   *  @param level Compression level from 0 to 9, -1 for zlib's default
+   *  @param format The container format to produce
+   *  @param chunkSize The size of each of the input and output chunks
+   *  @param globalErr Whether or not global errors are enabled
+   */
+  explicit ZlibStreamWriter(IStreamWriter& sink, int32_t level = -1, Format format = Format::Zlib,
+                            uint32_t chunkSize = DefaultChunkSize, bool globalErr = true);
+  ~ZlibStreamWriter() override;
+
+  ZlibStreamWriter(const ZlibStreamWriter&) = delete;
+  ZlibStreamWriter& operator=(const ZlibStreamWriter&) = delete;
+
+  /*! @brief Only forward seeks are possible, the skipped range is written as zeros */
+  void seek(int64_t pos, SeekOrigin origin = SeekOrigin::Current) override;
+  uint64_t position() const override { return m_position; }
+  uint64_t length() const override { return m_position; }
+  void writeUBytes(const uint8_t* data, uint64_t len) override;
+
+  /*! @brief Pushes everything written so far through to the sink on a byte boundary (Z_SYNC_FLUSH),
+   *         at some cost in compression ratio
+   */
+  void flush();
+
+  /*! @brief Writes the end of the compressed stream, further writes are errors until reset() */
+  void finish();
+
+  /*! @brief Starts a new compressed stream at the sink's current position, reusing the deflate state */
+  void reset();
+
+  bool finished() const { return m_finished; }
+
+private:
+  void deflateBuffer(const uint8_t* data, uint64_t len, int flush);
+
+  IStreamWriter& m_sink;
+  std::unique_ptr<z_stream_s> m_strm;
+  std::unique_ptr<uint8_t[]> m_in;
+  std::unique_ptr<uint8_t[]> m_out;
+  uint32_t m_chunkSize;
+  uint32_t m_inLen = 0;
+  uint64_t m_position = 0;
+  bool m_initialized = false;
+  bool m_finished = false;
+  bool m_globalErr;
+};
+} // namespace athena::io
@@ -1,7 +1,20 @@
 #include "LZ77/LZLookupTable.hpp"
 #include "LZ77/LZBase.hpp"
 
+#include <algorithm>
+#include <memory>
+
 namespace {
+// Candidates the fast level looks at per position
+constexpr uint32_t FastChainLength = 16;
+
+// Input is parsed this much at a time, which bounds the memory the optimal parse needs
+constexpr uint32_t SegmentSize = 0x10000;
+
+// The optimal parse prices every match length up to this one. Past it, which covers LZ11's four byte encoding,
+// only the longest match is tried, and a match this long lets the following positions reuse it without searching
+constexpr uint32_t OptimalLengthLimit = 0x110;
+
 // Returns the full length of string2 if they are equal else
 // Return the number of characters that were equal before they weren't equal
 int subMatch(const uint8_t* str1, const uint8_t* str2, const int len) {
@@ -89,6 +102,232 @@ void LZBase::setMinimumOffset(uint32_t minimumOffset) { m_minOffset = minimumOff
 
 uint32_t LZBase::minimumOffset() const { return m_minOffset; }
 
+void LZBase::setLevel(Level level) { m_level = level; }
+
+LZBase::Level LZBase::level() const { return m_level; }
+
+uint32_t LZBase::compress(const uint8_t* src, uint8_t** dest, uint32_t srcLength) {
+  const uint32_t bound = compressBound(srcLength);
+  auto out = std::unique_ptr<uint8_t[]>(new uint8_t[bound]);
+  const uint32_t outLen = compressInto({src, srcLength}, {out.get(), bound});
+  *dest = out.release();
+  return outLen;
+}
+
+uint32_t LZBase::decompress(const uint8_t* src, uint8_t** dest, uint32_t srcLength) {
+  uint32_t uncompressedSize;
+  if (readHeader({src, srcLength}, uncompressedSize) == 0)
+    return 0;
+
+  auto out = std::unique_ptr<uint8_t[]>(new uint8_t[uncompressedSize]);
+  if (decompressInto({src, srcLength}, {out.get(), uncompressedSize}) != uncompressedSize)
+    return 0;
+
+  *dest = out.release();
+  return uncompressedSize;
+}
+
+uint32_t LZBase::compressBound(uint32_t srcLength) const {
+  // Every byte as a literal plus a flag byte per block, and at the Normal level the end of data markers the
+  // original encoder filled the last block with
+  uint8_t scratch[8];
+  uint32_t bound = writeHeader(scratch, srcLength) + srcLength + (srcLength + m_blockSize - 1) / m_blockSize;
+  if (m_level == Level::Normal)
+    bound += (m_blockSize - 1) * encodeMatch({UINT32_MAX, 0}, scratch);
+  return (bound + 3) & ~3u;
+}
+
+uint32_t LZBase::compressInto(std::span<const uint8_t> src, std::span<uint8_t> dst) {
+  const uint32_t srcLength = static_cast<uint32_t>(src.size());
+  if (dst.size() < compressBound(srcLength))
+    return 0;
+
+  m_lookupTable.setMaxChain(m_level == Level::Fast ? FastChainLength : 0);
+  uint32_t outLen = writeHeader(dst.data(), srcLength);
+  outLen += encodeWith(m_lookupTable, m_scratch, src.data(), 0, srcLength, dst.data() + outLen,
+                       m_level == Level::Normal);
+
+  // Add zeros until the file is a multiple of 4
+  while (outLen % 4)
+    dst[outLen++] = 0;
+  return outLen;
+}
+
+uint32_t LZBase::encodeRange(const uint8_t* src, uint32_t begin, uint32_t end, uint8_t* dst) const {
+  LZLookupTable lookupTable(m_minMatch, m_slidingWindow, m_readAheadBuffer);
+  if (m_level == Level::Fast)
+    lookupTable.setMaxChain(FastChainLength);
+  ParseScratch scratch;
+  return encodeWith(lookupTable, scratch, src, begin, end, dst, false);
+}
+
+uint32_t LZBase::encodeWith(LZLookupTable& table, ParseScratch& scratch, const uint8_t* src, uint32_t begin,
+                            uint32_t end, uint8_t* dst, bool endMarkers) const {
+  // Offsets in the table are relative to the start of the window, fill it with every position before begin
+  const uint8_t* dataBegin = src + begin - std::min(begin, static_cast<uint32_t>(m_slidingWindow));
+  const uint8_t* dataEnd = src + end;
+  for (const uint8_t* ptr = dataBegin; ptr < src + begin; ++ptr)
+    table.insert(ptr, dataBegin, dataEnd);
+
+  const uint8_t* ptrStart = src + begin;
+  const uint8_t* literal = ptrStart;
+  uint8_t* out = dst;
+  uint8_t* flags = nullptr;
+  int32_t blockOps = m_blockSize;
+  while (ptrStart < dataEnd) {
+    const uint8_t* segEnd = ptrStart + std::min(static_cast<uint32_t>(dataEnd - ptrStart), SegmentSize);
+    scratch.ops.clear();
+    if (m_level == Level::Lazy)
+      ptrStart = parseLazy(table, scratch, dataBegin, ptrStart, segEnd, dataEnd);
+    else if (m_level == Level::Optimal)
+      ptrStart = parseOptimal(table, scratch, dataBegin, ptrStart, segEnd, dataEnd);
+    else
+      ptrStart = parseGreedy(table, scratch, dataBegin, ptrStart, segEnd, dataEnd);
+
+    for (const LZLengthOffset& op : scratch.ops) {
+      if (blockOps == m_blockSize) {
+        flags = out++;
+        *flags = 0;
+        blockOps = 0;
+      }
+
+      if (op.length >= static_cast<uint32_t>(m_minMatch)) {
+        out += encodeMatch(op, out);
+        literal += op.length;
+        *flags |= (1 << (7 - blockOps));
+      } else {
+        *out++ = *literal++;
+      }
+      ++blockOps;
+    }
+  }
+
+  // The original encoder kept searching past the end of the data to fill its last block, and the search reported
+  // those positions as matches of length -1. Decoders stop before reaching them, emit them for identical output.
+  if (endMarkers) {
+    for (; flags && blockOps < m_blockSize; ++blockOps) {
+      out += encodeMatch({UINT32_MAX, 0}, out);
+      *flags |= (1 << (7 - blockOps));
+    }
+  }
+
+  return static_cast<uint32_t>(out - dst);
+}
+
+const uint8_t* LZBase::parseGreedy(LZLookupTable& table, ParseScratch& scratch, const uint8_t* dataBegin,
+                                   const uint8_t* ptr, const uint8_t* segEnd, const uint8_t* dataEnd) const {
+  std::vector<LZLengthOffset>& ops = scratch.ops;
+  while (ptr < segEnd) {
+    const LZLengthOffset match = table.search(ptr, dataBegin, dataEnd);
+    ops.push_back(match);
+    ptr += match.length >= static_cast<uint32_t>(m_minMatch) ? match.length : 1;
+  }
+  return ptr;
+}
+
+const uint8_t* LZBase::parseLazy(LZLookupTable& table, ParseScratch& scratch, const uint8_t* dataBegin,
+                                 const uint8_t* ptr, const uint8_t* segEnd, const uint8_t* dataEnd) const {
+  std::vector<LZLengthOffset>& ops = scratch.ops;
+  const uint32_t minMatch = static_cast<uint32_t>(m_minMatch);
+  LZLengthOffset match = table.find(ptr, dataBegin, dataEnd);
+  while (ptr < segEnd) {
+    table.insert(ptr, dataBegin, dataEnd);
+
+    // A literal now pays off when the next position matches further
+    if (match.length >= minMatch && ptr + 1 < dataEnd) {
+      const LZLengthOffset next = table.find(ptr + 1, dataBegin, dataEnd);
+      if (next.length > match.length) {
+        ops.push_back({0, 0});
+        ++ptr;
+        match = next;
+        continue;
+      }
+    }
+
+    if (match.length >= minMatch) {
+      ops.push_back(match);
+      for (uint32_t i = 1; i < match.length; ++i)
+        table.insert(ptr + i, dataBegin, dataEnd);
+      ptr += match.length;
+    } else {
+      ops.push_back({0, 0});
+      ++ptr;
+    }
+
+    if (ptr < segEnd)
+      match = table.find(ptr, dataBegin, dataEnd);
+  }
+  return ptr;
+}
+
+const uint8_t* LZBase::parseOptimal(LZLookupTable& table, ParseScratch& scratch, const uint8_t* dataBegin,
+                                    const uint8_t* ptr, const uint8_t* segEnd, const uint8_t* dataEnd) const {
+  std::vector<LZLengthOffset>& ops = scratch.ops;
+  const uint32_t minMatch = static_cast<uint32_t>(m_minMatch);
+  const uint32_t count = static_cast<uint32_t>(segEnd - ptr);
+
+  // Longest match at every position, clamped to the segment so the costs below cover it
+  std::vector<LZLengthOffset>& matches = scratch.matches;
+  matches.resize(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    if (i > 0 && matches[i - 1].length > OptimalLengthLimit) {
+      matches[i] = {matches[i - 1].length - 1, matches[i - 1].offset};
+    } else {
+      matches[i] = table.find(ptr + i, dataBegin, dataEnd);
+      matches[i].length = std::min(matches[i].length, count - i);
+    }
+    table.insert(ptr + i, dataBegin, dataEnd);
+  }
+
+  // Bits a match of each priced length takes, including its flag bit
+  uint32_t matchBits[OptimalLengthLimit + 1];
+  for (uint32_t length = minMatch; length <= OptimalLengthLimit; ++length)
+    matchBits[length] = encodedMatchSize(length) * 8 + 1;
+
+  // Cheapest encoding of the rest of the segment from each position, in bits, counting the flag bit of every
+  // operation. choice holds the match length taken there, or 0 for a literal.
+  std::vector<uint32_t>& cost = scratch.cost;
+  std::vector<uint32_t>& choice = scratch.choice;
+  cost.resize(count + 1);
+  choice.resize(count);
+  cost[count] = 0;
+  for (uint32_t i = count; i-- > 0;) {
+    cost[i] = 9 + cost[i + 1];
+    choice[i] = 0;
+
+    const uint32_t longest = matches[i].length;
+    if (longest < minMatch)
+      continue;
+
+    const uint32_t tried = std::min(longest, OptimalLengthLimit);
+    for (uint32_t length = minMatch; length <= tried; ++length) {
+      const uint32_t matchCost = matchBits[length] + cost[i + length];
+      if (matchCost < cost[i]) {
+        cost[i] = matchCost;
+        choice[i] = length;
+      }
+    }
+    if (longest > tried) {
+      const uint32_t matchCost = encodedMatchSize(longest) * 8 + 1 + cost[i + longest];
+      if (matchCost < cost[i]) {
+        cost[i] = matchCost;
+        choice[i] = longest;
+      }
+    }
+  }
+
+  for (uint32_t i = 0; i < count;) {
+    if (choice[i]) {
+      ops.push_back({choice[i], matches[i].offset});
+      i += choice[i];
+    } else {
+      ops.push_back({0, 0});
+      ++i;
+    }
+  }
+  return segEnd;
+}
+
 /*
   DerricMc:
   This search function is my own work and is no way affiliated with any one else
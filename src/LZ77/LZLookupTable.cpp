@@ -1,7 +1,8 @@
 #include "LZ77/LZLookupTable.hpp"
 #include <algorithm>
+#include <cstring>
 
-LZLookupTable::LZLookupTable() : m_buffer(m_minimumMatch) {}
+LZLookupTable::LZLookupTable() = default;
 
 LZLookupTable::LZLookupTable(int32_t minimumMatch, int32_t slidingWindow, int32_t lookAheadWindow) {
   if (minimumMatch > 0)
@@ -15,12 +16,12 @@ LZLookupTable::LZLookupTable(int32_t minimumMatch, int32_t slidingWindow, int32_
     m_slidingWindow = 4096;
 
   setLookAheadWindow(lookAheadWindow);
-
-  m_buffer.reserve(m_minimumMatch);
 }
 
 LZLookupTable::~LZLookupTable() = default;
 
+void LZLookupTable::setMaxChain(uint32_t maxChain) { m_maxChain = maxChain ? maxChain : UINT32_MAX; }
+
 void LZLookupTable::setLookAheadWindow(int32_t lookAheadWindow) {
   if (lookAheadWindow > 0)
     m_lookAheadWindow = lookAheadWindow;
@@ -28,6 +29,97 @@ void LZLookupTable::setLookAheadWindow(int32_t lookAheadWindow) {
     m_lookAheadWindow = 18;
 }
 
+void LZLookupTable::reset() {
+  uint32_t ringSize = 1;
+  while (ringSize < static_cast<uint32_t>(m_slidingWindow))
+    ringSize <<= 1;
+
+  m_head.assign(size_t(1) << HashBits, -1);
+  m_prev.resize(ringSize);
+  m_prevMask = ringSize - 1;
+  m_insertEnd = 0;
+}
+
+uint32_t LZLookupTable::hash(const uint8_t* pos) const {
+  uint32_t v = 0;
+  for (int32_t i = 0; i < std::min(m_minimumMatch, 4); ++i)
+    v = (v << 8) | pos[i];
+  return (v * 2654435761u) >> (32 - HashBits);
+}
+
+void LZLookupTable::insert(const uint8_t* dataBegin, int32_t offset) {
+  const uint32_t h = hash(dataBegin + offset);
+  m_prev[offset & m_prevMask] = m_head[h];
+  m_head[h] = offset;
+  m_insertEnd = offset + 1;
+}
+
+void LZLookupTable::insert(const uint8_t* curPos, const uint8_t* dataBegin, const uint8_t* dataEnd) {
+  const int32_t currentOffset = static_cast<int32_t>(curPos - dataBegin);
+
+  // Every pass over new data starts at its beginning, the tables are allocated then the first time
+  if (currentOffset == 0 || m_head.empty())
+    reset();
+
+  // Positions too close to the end to hold a key can never be matched against
+  if ((dataEnd - curPos) >= m_minimumMatch)
+    insert(dataBegin, currentOffset);
+  else
+    m_insertEnd = currentOffset + 1;
+}
+
+LZLengthOffset LZLookupTable::find(const uint8_t* curPos, const uint8_t* dataBegin, const uint8_t* dataEnd) const {
+  return findMatch(curPos, dataBegin, dataEnd, -1);
+}
+
+LZLengthOffset LZLookupTable::findMatch(const uint8_t* curPos, const uint8_t* dataBegin, const uint8_t* dataEnd,
+                                        int32_t skipped) const {
+  LZLengthOffset loPair = {0, 0};
+  const int32_t currentOffset = static_cast<int32_t>(curPos - dataBegin);
+  if (m_head.empty() || currentOffset <= 0 || curPos >= dataEnd || (dataEnd - curPos) < m_minimumMatch)
+    return loPair;
+
+  // The table holds the last slidingWindow positions inserted
+  const int32_t windowStart = std::max(0, currentOffset - m_slidingWindow);
+  const int32_t lookAheadBufferLength =
+      ((dataEnd - curPos) < m_lookAheadWindow) ? static_cast<int32_t>(dataEnd - curPos) : m_lookAheadWindow;
+
+  // Newest first, so when lengths are the same the closer offset to the lookahead buffer wins
+  uint32_t chain = 0;
+  for (int32_t pos = m_head[hash(curPos)]; pos >= windowStart && chain < m_maxChain;
+       pos = m_prev[pos & m_prevMask], ++chain) {
+    const uint8_t* candidate = dataBegin + pos;
+    // Only a candidate that also matches at the current best length can beat it
+    if (pos == skipped || pos >= currentOffset || candidate[loPair.length] != curPos[loPair.length] ||
+        std::memcmp(candidate, curPos, m_minimumMatch) != 0)
+      continue;
+
+    int32_t matchLength = m_minimumMatch;
+    while (matchLength + 8 <= lookAheadBufferLength) {
+      uint64_t a, b;
+      std::memcpy(&a, candidate + matchLength, sizeof(a));
+      std::memcpy(&b, curPos + matchLength, sizeof(b));
+      if (a != b)
+        break;
+      matchLength += 8;
+    }
+    while (matchLength < lookAheadBufferLength && candidate[matchLength] == curPos[matchLength])
+      ++matchLength;
+
+    // Store the longest match found so far into length_offset struct.
+    if (loPair.length < (uint32_t)matchLength) {
+      loPair.length = matchLength;
+      loPair.offset = currentOffset - pos;
+    }
+
+    // Found the longest match so break out of loop
+    if (loPair.length == (uint32_t)lookAheadBufferLength)
+      break;
+  }
+
+  return loPair;
+}
+
 LZLengthOffset LZLookupTable::search(const uint8_t* curPos, const uint8_t* dataBegin, const uint8_t* dataEnd) {
   LZLengthOffset loPair = {0, 0};
 
@@ -37,72 +129,33 @@ LZLengthOffset LZLookupTable::search(const uint8_t* curPos, const uint8_t* dataB
     return loPair;
   }
 
-  std::copy(curPos, curPos + m_minimumMatch, m_buffer.begin());
-  int32_t currentOffset = static_cast<int32_t>(curPos - dataBegin);
+  const int32_t currentOffset = static_cast<int32_t>(curPos - dataBegin);
 
   // Find code
-  if (currentOffset > 0 && (dataEnd - curPos) >= m_minimumMatch) {
-    auto elements = table.equal_range(m_buffer);
-    elements.second--;
-    elements.first--;
-
-    // Iterate over keys in reverse order. C++11 guarantees that the relative order of elements is maintained for the
-    // same key
-    for (auto iter = elements.second; iter != elements.first; iter--) {
-      int32_t matchLength = m_minimumMatch;
-      int32_t lookAheadBufferLength =
-          ((dataEnd - curPos) < m_lookAheadWindow) ? static_cast<int32_t>(dataEnd - curPos) : m_lookAheadWindow;
-
-      for (; matchLength < lookAheadBufferLength; ++matchLength) {
-        if (*(dataBegin + iter->second + matchLength) != *(curPos + matchLength))
-          break;
-      }
-
-      // Store the longest match found so far into length_offset struct.
-      // When lengths are the same the closer offset to the lookahead buffer wins
-      if (loPair.length < (uint32_t)matchLength) {
-        loPair.length = matchLength;
-        loPair.offset = currentOffset - iter->second;
-      }
-
-      // Found the longest match so break out of loop
-      if (loPair.length == (uint32_t)m_lookAheadWindow)
-        break;
-    }
+  if (currentOffset > 0) {
+    // The multimap this table replaces never visited the oldest of its first two entries when that entry's key
+    // sorted first, a side effect of stepping before begin(). Skip it the same way so output stays identical.
+    const int32_t windowStart = std::max(0, m_insertEnd - m_slidingWindow);
+    int32_t skipped = -1;
+    if (m_insertEnd - windowStart == 1 ||
+        (m_insertEnd - windowStart == 2 && (dataEnd - curPos) >= m_minimumMatch &&
+         std::memcmp(dataBegin + windowStart + 1, dataBegin + windowStart, m_minimumMatch) >= 0))
+      skipped = windowStart;
+
+    loPair = findMatch(curPos, dataBegin, dataEnd, skipped);
   }
 
   // end find code
   // Insert code
-  table.insert(std::make_pair(m_buffer, currentOffset));
+  insert(curPos, dataBegin, dataEnd);
 
   for (uint32_t i = 1; i < loPair.length; i++) {
     if (dataEnd - (curPos + i) < m_minimumMatch)
       break;
 
-    std::copy(curPos + i, curPos + m_minimumMatch + i, m_buffer.begin());
-    table.insert(std::make_pair(m_buffer, currentOffset + i));
+    insert(dataBegin, currentOffset + i);
   }
 
   // end insert code
-  // Delete code
-  int32_t slidingWindowOffset = std::max(0, currentOffset - m_slidingWindow); // Absolute offset
-  int32_t tablesize = static_cast<int32_t>(table.size());
-
-  for (int32_t i = 0; i < tablesize - m_slidingWindow; ++i) {
-    std::copy(dataBegin + slidingWindowOffset + i, dataBegin + slidingWindowOffset + m_minimumMatch + i,
-              m_buffer.begin());
-    auto elements = table.equal_range(m_buffer);
-
-    for (auto iter = elements.first; iter != elements.second; iter++) {
-      if (slidingWindowOffset + i == iter->second) {
-        table.erase(iter);
-        // There should no occurance of the map with the same value
-        break;
-      }
-    }
-  }
-
-  // end delete code
   return loPair;
-  // break lookupTable.cpp:109 if table.size()> 4096
 }
@@ -2,11 +2,11 @@
 
 #include <cstddef>
 #include <cstring>
-#include <memory>
 
+#include "LZ77/LZCopy.hpp"
 #include "LZ77/LZLookupTable.hpp"
 
-#include <athena/MemoryWriter.hpp>
+#include <athena/Utility.hpp>
 
 LZType10::LZType10(int32_t MinimumOffset, int32_t SlidingWindow, int32_t MinimumMatch, int32_t BlockSize)
 : LZBase(MinimumOffset, SlidingWindow, MinimumMatch, BlockSize) {
@@ -15,125 +15,94 @@ LZType10::LZType10(int32_t MinimumOffset, int32_t SlidingWindow, int32_t Minimum
   m_readAheadBuffer = m_minMatch + 0xF;
 }
 
-uint32_t LZType10::compress(const uint8_t* src, uint8_t** dstBuf, uint32_t srcLength) {
+uint32_t LZType10::writeHeader(uint8_t* dst, uint32_t srcLength) const {
   uint32_t encodeSize = (srcLength << 8) | (0x10);
   encodeSize = athena::utility::LittleUint32(encodeSize); // File size needs to be written as little endian always
+  memcpy(dst, &encodeSize, sizeof(encodeSize));
+  return sizeof(encodeSize);
+}
 
-  athena::io::MemoryCopyWriter outbuf("tmp");
-  outbuf.writeUint32(encodeSize);
-
-  const uint8_t* ptrStart = src;
-  const uint8_t* ptrEnd = src + srcLength;
-
-  // At most their will be two bytes written if the bytes can be compressed. So if all bytes in the block can be
-  // compressed it would take blockSize*2 bytes
-  auto compressedBytes = std::unique_ptr<uint8_t[]>(new uint8_t[m_blockSize * 2]); // Holds the compressed bytes yet to be written
-
-  while (ptrStart < ptrEnd) {
-    uint8_t blockLen = 0;
-    // In Binary represents 1 if byte is compressed or 0 if not compressed
-    // For example 01001000 means that the second and fifth byte in the blockSize from the left is compressed
-    uint8_t* ptrBytes = compressedBytes.get();
-
-    for (int32_t i = 0; i < m_blockSize; i++) {
-      // length_offset searchResult=Search(ptrStart, filedata, ptrEnd);
-      const LZLengthOffset searchResult = m_lookupTable.search(ptrStart, src, ptrEnd);
-
-      // If the number of bytes to be compressed is at least the size of the Minimum match
-      if (searchResult.length >= static_cast<uint32_t>(m_minMatch)) {
-        // Gotta swap the bytes since system is wii is big endian and most computers are little endian
-        uint16_t lenOff = (((searchResult.length - m_minMatch) & 0xF) << 12) | ((searchResult.offset - 1) & 0xFFF);
-        athena::utility::BigUint16(lenOff);
-
-        memcpy(ptrBytes, &lenOff, sizeof(uint16_t));
-
-        ptrBytes += sizeof(uint16_t);
-
-        ptrStart += searchResult.length;
+uint32_t LZType10::matchSize(uint8_t) const { return sizeof(uint16_t); }
 
-        blockLen |= (1 << (7 - i));
-        // Stores which of the next 8 bytes is compressed
-        // bit 1 for compress and bit 0 for not compressed
-      } else {
-        *ptrBytes++ = *ptrStart++;
-      }
-    }
+uint32_t LZType10::encodeMatch(const LZLengthOffset& match, uint8_t* dst) const {
+  // Gotta swap the bytes since system is wii is big endian and most computers are little endian
+  uint16_t lenOff = (((match.length - m_minMatch) & 0xF) << 12) | ((match.offset - 1) & 0xFFF);
+  athena::utility::BigUint16(lenOff);
+  memcpy(dst, &lenOff, sizeof(uint16_t));
+  return sizeof(uint16_t);
+}
 
-    outbuf.writeByte(blockLen);
-    outbuf.writeUBytes(compressedBytes.get(), static_cast<uint64_t>(ptrBytes - compressedBytes.get()));
-  }
+uint32_t LZType10::encodedMatchSize(uint32_t) const { return sizeof(uint16_t); }
 
-  // Add zeros until the file is a multiple of 4
-  while ((outbuf.position() % 4) != 0) {
-    outbuf.writeByte(0);
-  }
+uint32_t LZType10::readHeader(std::span<const uint8_t> src, uint32_t& uncompressedSize) const {
+  if (src.size() < sizeof(uint32_t) || src[0] != 0x10)
+    return 0;
 
-  *dstBuf = outbuf.data();
-  outbuf.save();
-  return static_cast<uint32_t>(outbuf.length());
+  // The compressed file has the filesize encoded in little endian, after the encode flag
+  std::memcpy(&uncompressedSize, src.data(), sizeof(uncompressedSize));
+  uncompressedSize = athena::utility::LittleUint32(uncompressedSize) >> 8;
+  return sizeof(uint32_t);
 }
 
-uint32_t LZType10::decompress(const uint8_t* src, uint8_t** dst, uint32_t srcLength) {
-  if (*src != 0x10) {
-    return 0;
-  }
-
+uint32_t LZType10::decompressInto(std::span<const uint8_t> src, std::span<uint8_t> dst) const {
   // Size of data when it is uncompressed
   uint32_t uncompressedSize;
-  std::memcpy(&uncompressedSize, src, sizeof(uncompressedSize));
-
-  // The compressed file has the filesize encoded in little endian
-  athena::utility::LittleUint32(uncompressedSize);
-
-  // first byte is the encode flag
-  uncompressedSize = uncompressedSize >> 8;
+  const uint32_t headerSize = readHeader(src, uncompressedSize);
+  if (headerSize == 0 || uncompressedSize > dst.size())
+    return 0;
 
-  auto uncompressedData = std::unique_ptr<uint8_t[]>(new uint8_t[uncompressedSize]);
-  uint8_t* outputPtr = uncompressedData.get();
-  uint8_t* outputEndPtr = uncompressedData.get() + uncompressedSize;
-  const uint8_t* inputPtr = src + 4;
-  const uint8_t* inputEndPtr = src + srcLength;
+  uint8_t* outputPtr = dst.data();
+  uint8_t* const outputEndPtr = dst.data() + uncompressedSize;
+  const uint8_t* inputPtr = src.data() + headerSize;
+  const uint8_t* const inputEndPtr = src.data() + src.size();
 
-  while (inputPtr < inputEndPtr && outputPtr < outputEndPtr) {
+  while (outputPtr < outputEndPtr) {
+    if (inputPtr == inputEndPtr)
+      return 0;
     const uint8_t isCompressed = *inputPtr++;
 
-    for (uint32_t i = 0; i < static_cast<uint32_t>(m_blockSize); i++) {
+    if (isCompressed == 0 && m_blockSize == 8 && inputEndPtr - inputPtr >= 8 && outputEndPtr - outputPtr >= 8) {
+      // A whole block of literals
+      std::memcpy(outputPtr, inputPtr, 8);
+      inputPtr += 8;
+      outputPtr += 8;
+      continue;
+    }
+
+    for (int32_t i = 0; i < m_blockSize && outputPtr < outputEndPtr; i++) {
       // Checks to see if the next byte is compressed by looking
       // at its binary representation - E.g 10010000
       // This says that the first extracted byte and the four extracted byte is compressed
       if ((isCompressed >> (7 - i)) & 0x1) {
+        if (inputEndPtr - inputPtr < 2)
+          return 0;
+
         uint16_t lenOff;
-        memcpy(&lenOff, inputPtr, sizeof(uint16_t));
+        std::memcpy(&lenOff, inputPtr, sizeof(uint16_t));
         athena::utility::BigUint16(lenOff);
         inputPtr += sizeof(uint16_t); // Move forward two bytes
         // length offset pair has been decoded.
-        LZLengthOffset decoding;
-        decoding.length = (lenOff >> 12) + m_minMatch;
-        decoding.offset = static_cast<uint16_t>((lenOff & 0xFFF) + 1);
-
-        if ((outputPtr - decoding.offset) < uncompressedData.get()) {
-          // If the offset to look for uncompressed is passed the current uncompresed data then the data is not
-          // compressed
-          dst = nullptr;
+        const uint32_t length = (lenOff >> 12) + m_minMatch;
+        const uint32_t offset = (lenOff & 0xFFF) + 1;
+
+        // The offset has to stay inside the data decompressed so far, and the run inside the output
+        if (offset > static_cast<size_t>(outputPtr - dst.data()) ||
+            length > static_cast<size_t>(outputEndPtr - outputPtr))
           return 0;
-        }
 
-        for (size_t j = 0; j < decoding.length; ++j) {
-          outputPtr[j] = (outputPtr - decoding.offset)[j];
-        }
+        if (static_cast<size_t>(outputEndPtr - outputPtr) - length >= LZCopySlack)
+          lzCopyMatch(outputPtr, offset, length);
+        else
+          lzCopyMatchExact(outputPtr, offset, length);
 
-        outputPtr += decoding.length;
+        outputPtr += length;
       } else {
+        if (inputPtr == inputEndPtr)
+          return 0;
         *outputPtr++ = *inputPtr++;
       }
-
-      if (!(inputPtr < inputEndPtr && outputPtr < outputEndPtr)) {
-        break;
-      }
     }
   }
 
-  *dst = uncompressedData.release();
-
   return uncompressedSize;
 }
@@ -2,11 +2,11 @@
 
 #include <cstddef>
 #include <cstring>
-#include <memory>
 
+#include "LZ77/LZCopy.hpp"
 #include "LZ77/LZLookupTable.hpp"
 
-#include <athena/MemoryWriter.hpp>
+#include <athena/Utility.hpp>
 
 LZType11::LZType11(int32_t minimumOffset, int32_t slidingWindow, int32_t minimumMatch, int32_t blockSize)
 : LZBase(minimumOffset, slidingWindow, minimumMatch, blockSize) {
@@ -14,30 +14,28 @@ LZType11::LZType11(int32_t minimumOffset, int32_t slidingWindow, int32_t minimum
   m_lookupTable.setLookAheadWindow(m_readAheadBuffer);
 }
 
-uint32_t LZType11::compress(const uint8_t* src, uint8_t** dst, uint32_t srcLength) {
-  athena::io::MemoryCopyWriter outbuff("tmp");
-
+uint32_t LZType11::writeHeader(uint8_t* dst, uint32_t srcLength) const {
   if (srcLength > 0xFFFFFF) { // If length is greater than 24 bits or 16 Megs
     uint32_t encodeFlag = 0x11;
     athena::utility::LittleUint32(encodeFlag);
     athena::utility::LittleUint32(srcLength); // Filesize data is little endian
-    outbuff.writeUint32(encodeFlag);
-    outbuff.writeUint32(srcLength);
-  } else {
-    uint32_t encodeSize = (srcLength << 8) | (0x11);
-    athena::utility::LittleUint32(encodeSize);
-    outbuff.writeUint32(encodeSize);
+    memcpy(dst, &encodeFlag, 4);
+    memcpy(dst + 4, &srcLength, 4);
+    return 8;
   }
 
-  const uint8_t* ptrStart = src;
-  const uint8_t* ptrEnd = src + srcLength;
-
-  // At most their will be two bytes written if the bytes can be compressed. So if all bytes in the block can be
-  // compressed it would take blockSize*2 bytes
+  uint32_t encodeSize = (srcLength << 8) | (0x11);
+  athena::utility::LittleUint32(encodeSize);
+  memcpy(dst, &encodeSize, 4);
+  return 4;
+}
 
-  // Holds the compressed bytes yet to be written
-  auto compressedBytes = std::unique_ptr<uint8_t[]>(new uint8_t[m_blockSize * 2]);
+uint32_t LZType11::matchSize(uint8_t lead) const {
+  const uint8_t metaDataSize = lead >> 4;
+  return metaDataSize == 0 ? 3 : (metaDataSize == 1 ? 4 : 2);
+}
 
+uint32_t LZType11::encodeMatch(const LZLengthOffset& match, uint8_t* dst) const {
   const uint8_t maxTwoByteMatch = 0xF + 1;
   const uint8_t minThreeByteMatch = maxTwoByteMatch + 1; // Minimum Three byte match is maximum TwoByte match + 1
   const uint16_t maxThreeByteMatch = 0xFF + minThreeByteMatch;
@@ -58,156 +56,141 @@ uint32_t LZType11::compress(const uint8_t* src, uint8_t** dst, uint32_t srcLengt
   In the three byte case the first 4 bits are 0000
   In the four byte case the first 4 bits a 0001
   */
-  while (ptrStart < ptrEnd) {
-    uint8_t blockSize = 0;
-    // In Binary represents 1 if byte is compressed or 0 if not compressed
-    // For example 01001000 means that the second and fifth byte in the blockSize from the left is compressed
-    uint8_t* ptrBytes = compressedBytes.get();
-
-    for (int32_t i = 0; i < m_blockSize; i++) {
-      // length_offset searchResult=Search(filedata,ptrStart,ptrEnd);
-      const LZLengthOffset searchResult = m_lookupTable.search(ptrStart, src, ptrEnd);
-
-      // If the number of bytes to be compressed is at least the size of the Minimum match
-      if (searchResult.length >= static_cast<uint32_t>(m_minMatch)) {
-        // Gotta swap the bytes since system is wii is big endian and most computers are little endian
-
-        if (searchResult.length <= maxTwoByteMatch) {
-          uint16_t lenOff = ((((searchResult.length - 1) & 0xF) << 12) | // Bits 15-12
-                             ((searchResult.offset - 1) & 0xFFF)         // Bits 11-0
-          );
-          athena::utility::BigUint16(lenOff);
-          memcpy(ptrBytes, &lenOff, 2);
-          ptrBytes += 2;
-        } else if (searchResult.length <= maxThreeByteMatch) {
-          uint32_t lenOff = ((((searchResult.length - minThreeByteMatch) & 0xFF) << 12) | // Bits 20-12
-                             ((searchResult.offset - 1) & 0xFFF)                          // Bits 11-0
-          );
-          athena::utility::BigUint32(lenOff);
-          memcpy(ptrBytes, reinterpret_cast<uint8_t*>(&lenOff) + 1,
-                 3); // Make sure to copy the lower 24 bits. 0x12345678- This statement copies 0x123456
-          ptrBytes += 3;
-        } else if (searchResult.length <= static_cast<uint32_t>(maxFourByteMatch)) {
-          uint32_t lenOff = ((1 << 28) | // Bits 31-28 Flag to say that this is four bytes
-                             (((searchResult.length - minFourByteMatch) & 0xFFFF) << 12) | // Bits 28-12
-                             ((searchResult.offset - 1) & 0xFFF)                           // Bits 11-0
-          );
-          athena::utility::BigUint32(lenOff);
-          memcpy(ptrBytes, &lenOff, 4);
-          ptrBytes += 4;
-        }
 
-        ptrStart += searchResult.length;
-
-        blockSize |= (1 << (7 - i));
-        // Stores which of the next 8 bytes is compressed
-        // bit 1 for compress and bit 0 for not compressed
-      } else {
-        *ptrBytes++ = *ptrStart++;
-      }
-    }
-
-    outbuff.writeByte(blockSize);
-    outbuff.writeUBytes(compressedBytes.get(), static_cast<uint64_t>(ptrBytes - compressedBytes.get()));
+  // Gotta swap the bytes since system is wii is big endian and most computers are little endian
+  if (match.length <= maxTwoByteMatch) {
+    uint16_t lenOff = ((((match.length - 1) & 0xF) << 12) | // Bits 15-12
+                       ((match.offset - 1) & 0xFFF)         // Bits 11-0
+    );
+    athena::utility::BigUint16(lenOff);
+    memcpy(dst, &lenOff, 2);
+    return 2;
+  } else if (match.length <= maxThreeByteMatch) {
+    uint32_t lenOff = ((((match.length - minThreeByteMatch) & 0xFF) << 12) | // Bits 20-12
+                       ((match.offset - 1) & 0xFFF)                          // Bits 11-0
+    );
+    athena::utility::BigUint32(lenOff);
+    memcpy(dst, reinterpret_cast<uint8_t*>(&lenOff) + 1,
+           3); // Make sure to copy the lower 24 bits. 0x12345678- This statement copies 0x123456
+    return 3;
+  } else if (match.length <= static_cast<uint32_t>(maxFourByteMatch)) {
+    uint32_t lenOff = ((1 << 28) | // Bits 31-28 Flag to say that this is four bytes
+                       (((match.length - minFourByteMatch) & 0xFFFF) << 12) | // Bits 28-12
+                       ((match.offset - 1) & 0xFFF)                           // Bits 11-0
+    );
+    athena::utility::BigUint32(lenOff);
+    memcpy(dst, &lenOff, 4);
+    return 4;
   }
 
-  // Add zeros until the file is a multiple of 4
-  while ((outbuff.position() % 4) != 0) {
-    outbuff.writeByte(0);
-  }
+  return 0;
+}
 
-  *dst = outbuff.data();
-  return static_cast<uint32_t>(outbuff.length());
+uint32_t LZType11::encodedMatchSize(uint32_t length) const {
+  // Two bytes up to 0xF + 1, three up to 0xFF + 0x11 and four beyond
+  return length <= 0x10 ? 2 : (length <= 0x110 ? 3 : 4);
 }
 
-uint32_t LZType11::decompress(const uint8_t* src, uint8_t** dst, uint32_t srcLength) {
-  if (*src != 0x11) {
+uint32_t LZType11::readHeader(std::span<const uint8_t> src, uint32_t& uncompressedSize) const {
+  if (src.size() < sizeof(uint32_t) || src[0] != 0x11)
     return 0;
+
+  std::memcpy(&uncompressedSize, src.data(), sizeof(uncompressedSize));
+  athena::utility::LittleUint32(uncompressedSize); // The compressed file has the filesize encoded in little endian
+  uncompressedSize = uncompressedSize >> 8;         // First byte is the encode flag
+
+  // If the filesize var is zero then the true filesize is over 16MB and must be read in from the next 4 bytes
+  if (uncompressedSize == 0 && src.size() >= 2 * sizeof(uint32_t)) {
+    std::memcpy(&uncompressedSize, src.data() + 4, sizeof(uncompressedSize));
+    athena::utility::LittleUint32(uncompressedSize);
+    return 2 * sizeof(uint32_t);
   }
+  return sizeof(uint32_t);
+}
 
+uint32_t LZType11::decompressInto(std::span<const uint8_t> src, std::span<uint8_t> dst) const {
   uint32_t uncompressedLen;
-  std::memcpy(&uncompressedLen, src, sizeof(uncompressedLen));
-  athena::utility::LittleUint32(uncompressedLen); // The compressed file has the filesize encoded in little endian
-  uncompressedLen = uncompressedLen >> 8;         // First byte is the encode flag
-  uint32_t currentOffset = 4;
-
-  // If the filesize var is zero then the true filesize is over 14MB and must be read in from the next 4 bytes
-  if (uncompressedLen == 0) {
-    uint32_t filesize;
-    std::memcpy(&filesize, src + 4, sizeof(filesize));
-    filesize = athena::utility::LittleUint32(filesize);
-    currentOffset += 4;
-  }
+  const uint32_t headerSize = readHeader(src, uncompressedLen);
+  if (headerSize == 0 || uncompressedLen > dst.size())
+    return 0;
 
-  auto uncompressedData = std::unique_ptr<uint8_t[]>(new uint8_t[uncompressedLen]);
-  uint8_t* outputPtr = uncompressedData.get();
-  uint8_t* outputEndPtr = uncompressedData.get() + uncompressedLen;
-  const uint8_t* inputPtr = src + currentOffset;
-  const uint8_t* inputEndPtr = src + srcLength;
+  uint8_t* outputPtr = dst.data();
+  uint8_t* const outputEndPtr = dst.data() + uncompressedLen;
+  const uint8_t* inputPtr = src.data() + headerSize;
+  const uint8_t* const inputEndPtr = src.data() + src.size();
 
-  LZLengthOffset decoding;
   const uint8_t maxTwoByteMatch = 0xF + 1;
   const uint8_t threeByteDenorm = maxTwoByteMatch + 1; // Amount to add to length when compression is 3 bytes
   const uint16_t maxThreeByteMatch = 0xFF + threeByteDenorm;
   const uint16_t fourByteDenorm = maxThreeByteMatch + 1;
 
-  while (inputPtr < inputEndPtr && outputPtr < outputEndPtr) {
+  while (outputPtr < outputEndPtr) {
+    if (inputPtr == inputEndPtr)
+      return 0;
     const uint8_t isCompressed = *inputPtr++;
 
-    for (int32_t i = 0; i < m_blockSize; i++) {
+    if (isCompressed == 0 && m_blockSize == 8 && inputEndPtr - inputPtr >= 8 && outputEndPtr - outputPtr >= 8) {
+      // A whole block of literals
+      std::memcpy(outputPtr, inputPtr, 8);
+      inputPtr += 8;
+      outputPtr += 8;
+      continue;
+    }
+
+    for (int32_t i = 0; i < m_blockSize && outputPtr < outputEndPtr; i++) {
       // Checks to see if the next byte is compressed by looking
       // at its binary representation - E.g 10010000
       // This says that the first extracted byte and the four extracted byte is compressed
       if ((isCompressed >> (7 - i)) & 0x1) {
+        if (inputPtr == inputEndPtr)
+          return 0;
+
         const uint8_t metaDataSize = *inputPtr >> 4; // Look at the top 4 bits
+        const uint32_t encodedSize = matchSize(*inputPtr);
+        if (static_cast<size_t>(inputEndPtr - inputPtr) < encodedSize)
+          return 0;
 
+        uint32_t length;
+        uint32_t offset;
         if (metaDataSize >= 2) { // Two Bytes of Length/Offset MetaData
           uint16_t lenOff = 0;
-          memcpy(&lenOff, inputPtr, 2);
-          inputPtr += 2;
+          std::memcpy(&lenOff, inputPtr, 2);
           athena::utility::BigUint16(lenOff);
-          decoding.length = (lenOff >> 12) + 1;
-          decoding.offset = (lenOff & 0xFFF) + 1;
+          length = (lenOff >> 12) + 1;
+          offset = (lenOff & 0xFFF) + 1;
         } else if (metaDataSize == 0) { // Three Bytes of Length/Offset MetaData
           uint32_t lenOff = 0;
-          memcpy(reinterpret_cast<uint8_t*>(&lenOff) + 1, inputPtr, 3);
-          inputPtr += 3;
+          std::memcpy(reinterpret_cast<uint8_t*>(&lenOff) + 1, inputPtr, 3);
           athena::utility::BigUint32(lenOff);
-          decoding.length = (lenOff >> 12) + threeByteDenorm;
-          decoding.offset = (lenOff & 0xFFF) + 1;
-        } else if (metaDataSize == 1) { // Four Bytes of Length/Offset MetaData
+          length = (lenOff >> 12) + threeByteDenorm;
+          offset = (lenOff & 0xFFF) + 1;
+        } else { // Four Bytes of Length/Offset MetaData
           uint32_t lenOff = 0;
-          memcpy(&lenOff, inputPtr, 4);
-          inputPtr += 4;
+          std::memcpy(&lenOff, inputPtr, 4);
           athena::utility::BigUint32(lenOff);
-
-          decoding.length = ((lenOff >> 12) & 0xFFFF) + fourByteDenorm; // Gets rid of the Four byte flag
-          decoding.offset = (lenOff & 0xFFF) + 1;
-        } else {
-          return 0;
+          length = ((lenOff >> 12) & 0xFFFF) + fourByteDenorm; // Gets rid of the Four byte flag
+          offset = (lenOff & 0xFFF) + 1;
         }
+        inputPtr += encodedSize;
 
-        // If the offset to look for uncompressed is passed the
-        // current uncompresed data then the data is not compressed
-        if ((outputPtr - decoding.offset) < uncompressedData.get()) {
+        // The offset has to stay inside the data decompressed so far, and the run inside the output
+        if (offset > static_cast<size_t>(outputPtr - dst.data()) ||
+            length > static_cast<size_t>(outputEndPtr - outputPtr))
           return 0;
-        }
 
-        for (size_t j = 0; j < decoding.length; ++j) {
-          outputPtr[j] = (outputPtr - decoding.offset)[j];
-        }
+        if (static_cast<size_t>(outputEndPtr - outputPtr) - length >= LZCopySlack)
+          lzCopyMatch(outputPtr, offset, length);
+        else
+          lzCopyMatchExact(outputPtr, offset, length);
 
-        outputPtr += decoding.length;
+        outputPtr += length;
       } else {
+        if (inputPtr == inputEndPtr)
+          return 0;
         *outputPtr++ = *inputPtr++;
       }
-
-      if (!(inputPtr < inputEndPtr && outputPtr < outputEndPtr)) {
-        break;
-      }
     }
   }
 
-  *dst = uncompressedData.release();
   return uncompressedLen;
 }
@@ -0,0 +1,625 @@
+#include "athena/AsyncFile.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#else
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define AT_IO_URING 1
+#ifndef IORING_FEAT_SINGLE_MMAP
+// Headers from before 5.4 lack the flag, kernels that old never report it
+#define IORING_FEAT_SINGLE_MMAP (1U << 0)
+#endif
+#endif
+#endif
+#ifndef AT_IO_URING
+// Kernel headers without io_uring, the thread pool is the only backend
+#define AT_IO_URING 0
+#endif
+
+namespace athena::io {
+namespace {
+/* Intrusive FIFO of requests, linked through AsyncIORequest::next */
+struct RequestList {
+  AsyncIORequest* head = nullptr;
+  AsyncIORequest* tail = nullptr;
+
+  bool empty() const { return head == nullptr; }
+  void push(AsyncIORequest* req) {
+    req->next = nullptr;
+    if (tail)
+      tail->next = req;
+    else
+      head = req;
+    tail = req;
+  }
+  AsyncIORequest* pop() {
+    AsyncIORequest* req = head;
+    head = req->next;
+    if (!head)
+      tail = nullptr;
+    return req;
+  }
+  AsyncIORequest* take() {
+    AsyncIORequest* ret = head;
+    head = tail = nullptr;
+    return ret;
+  }
+};
+
+/* Performs a request synchronously, used by the thread pool workers */
+int64_t transferSync(const AsyncIORequest& req) {
+  auto* buf = static_cast<uint8_t*>(req.buf);
+  uint64_t done = 0;
+#ifndef _WIN32
+  while (done < req.len) {
+    const size_t chunk = size_t(req.len - done);
+    const off_t offset = off_t(req.offset + done);
+    const ssize_t ret = req.type == AsyncIORequest::Type::Read ? pread(int(req.handle), buf + done, chunk, offset)
+                                                               : pwrite(int(req.handle), buf + done, chunk, offset);
+    if (ret < 0 && errno == EINTR)
+      continue;
+    if (ret < 0)
+      return done ? int64_t(done) : -int64_t(errno);
+    if (ret == 0)
+      break;
+    done += uint64_t(ret);
+  }
+#else
+  while (done < req.len) {
+    OVERLAPPED ov = {};
+    ov.Offset = DWORD(req.offset + done);
+    ov.OffsetHigh = DWORD((req.offset + done) >> 32);
+    const DWORD chunk = DWORD(std::min<uint64_t>(req.len - done, 0x80000000));
+    DWORD ret = 0;
+    const BOOL ok = req.type == AsyncIORequest::Type::Read
+                        ? ReadFile(HANDLE(req.handle), buf + done, chunk, &ret, &ov)
+                        : WriteFile(HANDLE(req.handle), buf + done, chunk, &ret, &ov);
+    if (!ok) {
+      const DWORD err = GetLastError();
+      if (err == ERROR_HANDLE_EOF)
+        break;
+      return done ? int64_t(done) : -int64_t(err);
+    }
+    if (ret == 0)
+      break;
+    done += ret;
+  }
+#endif
+  return int64_t(done);
+}
+
+#if AT_IO_URING
+// SQEs point the kernel at AsyncIORequest::iov as a one-element struct iovec array
+using RequestIOVec = decltype(AsyncIORequest::iov);
+static_assert(sizeof(RequestIOVec) == sizeof(iovec) && alignof(RequestIOVec) == alignof(iovec),
+              "AsyncIORequest::iov must be laid out as struct iovec");
+static_assert(offsetof(RequestIOVec, base) == offsetof(iovec, iov_base) &&
+                  offsetof(RequestIOVec, len) == offsetof(iovec, iov_len),
+              "AsyncIORequest::iov must be laid out as struct iovec");
+
+/* Minimal io_uring driver using the raw syscalls, so no liburing dependency is needed */
+struct IOUring {
+  int fd = -1;
+  unsigned* sqHead = nullptr;
+  unsigned* sqTail = nullptr;
+  unsigned sqMask = 0;
+  unsigned sqEntries = 0;
+  unsigned* sqArray = nullptr;
+  io_uring_sqe* sqes = nullptr;
+  unsigned* cqHead = nullptr;
+  unsigned* cqTail = nullptr;
+  unsigned cqMask = 0;
+  io_uring_cqe* cqes = nullptr;
+
+  void* sqRing = nullptr;
+  size_t sqRingSize = 0;
+  void* cqRing = nullptr;
+  size_t cqRingSize = 0;
+  size_t sqesSize = 0;
+
+  unsigned queued = 0;   //!< Filled SQEs not yet passed to the kernel
+  unsigned inFlight = 0; //!< Passed to the kernel, completion not yet reaped
+
+  bool setup(uint32_t depth) {
+    io_uring_params params = {};
+    fd = int(syscall(__NR_io_uring_setup, depth, &params));
+    if (fd < 0)
+      return false;
+
+    sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMmap)
+      sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+
+    sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sqRing == MAP_FAILED) {
+      sqRing = nullptr;
+      destroy();
+      return false;
+    }
+    if (singleMmap) {
+      cqRing = sqRing;
+    } else {
+      cqRing = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+      if (cqRing == MAP_FAILED) {
+        cqRing = nullptr;
+        destroy();
+        return false;
+      }
+    }
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqesMem = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqesMem == MAP_FAILED) {
+      destroy();
+      return false;
+    }
+    sqes = static_cast<io_uring_sqe*>(sqesMem);
+
+    auto* sq = static_cast<uint8_t*>(sqRing);
+    sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sqEntries = params.sq_entries;
+    sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    auto* cq = static_cast<uint8_t*>(cqRing);
+    cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  void destroy() {
+    if (sqes)
+      munmap(sqes, sqesSize);
+    if (cqRing && cqRing != sqRing)
+      munmap(cqRing, cqRingSize);
+    if (sqRing)
+      munmap(sqRing, sqRingSize);
+    if (fd >= 0)
+      ::close(fd);
+    sqes = nullptr;
+    sqRing = cqRing = nullptr;
+    fd = -1;
+  }
+
+  /* Keeps in-flight requests within the SQ size, which also keeps the (larger) CQ from overflowing */
+  bool full() const { return queued + inFlight >= sqEntries; }
+
+  void prepare(AsyncIORequest& req) {
+    const unsigned tail = *sqTail;
+    const unsigned idx = tail & sqMask;
+    io_uring_sqe& sqe = sqes[idx];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = req.type == AsyncIORequest::Type::Read ? IORING_OP_READV : IORING_OP_WRITEV;
+    sqe.fd = int(req.handle);
+    sqe.off = req.offset;
+    sqe.addr = reinterpret_cast<uint64_t>(&req.iov);
+    sqe.len = 1;
+    sqe.user_data = reinterpret_cast<uint64_t>(&req);
+    sqArray[idx] = idx;
+    __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+    ++queued;
+  }
+
+  /* Hands up to submit queued SQEs to the kernel, optionally blocking until at least one completion is available.
+   * Returns 0 or a negative errno, -EAGAIN and -EBUSY meaning the kernel is short of room until completions are
+   * reaped.
+   */
+  int enter(unsigned submit, bool wait) {
+    for (;;) {
+      const unsigned flags = wait ? IORING_ENTER_GETEVENTS : 0;
+      const int ret = int(syscall(__NR_io_uring_enter, fd, submit, wait ? 1 : 0, flags, nullptr, 0));
+      if (ret < 0) {
+        if (errno == EINTR)
+          continue;
+        return -errno;
+      }
+      queued -= unsigned(ret);
+      inFlight += unsigned(ret);
+      return 0;
+    }
+  }
+
+  /* Takes back the SQEs the kernel has not consumed, completing their requests with err */
+  void failQueued(RequestList& done, int err) {
+    const unsigned head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+    for (unsigned i = head; i != *sqTail; ++i) {
+      auto* req = reinterpret_cast<AsyncIORequest*>(sqes[sqArray[i & sqMask]].user_data);
+      req->result = err;
+      done.push(req);
+    }
+    __atomic_store_n(sqTail, head, __ATOMIC_RELEASE);
+    queued = 0;
+  }
+
+  void reap(RequestList& done) {
+    unsigned head = *cqHead;
+    const unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+      const io_uring_cqe& cqe = cqes[head & cqMask];
+      auto* req = reinterpret_cast<AsyncIORequest*>(cqe.user_data);
+      req->result = cqe.res;
+      done.push(req);
+      --inFlight;
+      ++head;
+    }
+    __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+  }
+};
+#endif
+} // namespace
+
+struct AsyncIOContext::Impl {
+  Backend backend = Backend::ThreadPool;
+  size_t outstanding = 0;
+  RequestList ready; //!< Completed without reaching a backend (e.g. invalid handle)
+
+#if AT_IO_URING
+  IOUring ring;
+  RequestList pending; //!< Waiting for room in the submission queue
+#endif
+
+  std::mutex mutex;
+  std::condition_variable workCv;
+  std::condition_variable doneCv;
+  RequestList work;
+  RequestList done;
+  std::vector<std::thread> workers;
+  bool stopping = false;
+
+  void workerLoop() {
+    std::unique_lock lk(mutex);
+    for (;;) {
+      workCv.wait(lk, [this]() { return stopping || !work.empty(); });
+      if (stopping)
+        return;
+      AsyncIORequest* req = work.pop();
+      lk.unlock();
+      req->result = transferSync(*req);
+      lk.lock();
+      done.push(req);
+      doneCv.notify_one();
+    }
+  }
+};
+
+AsyncIOContext::AsyncIOContext(Backend backend, uint32_t queueDepth, uint32_t threadCount)
+: m_impl(std::make_unique<Impl>()) {
+#if AT_IO_URING
+  if (backend != Backend::ThreadPool && m_impl->ring.setup(std::max(queueDepth, 1u))) {
+    m_impl->backend = Backend::IOUring;
+    return;
+  }
+#endif
+  (void)backend;
+  (void)queueDepth;
+  m_impl->backend = Backend::ThreadPool;
+  threadCount = std::max(threadCount, 1u);
+  m_impl->workers.reserve(threadCount);
+  for (uint32_t i = 0; i < threadCount; ++i)
+    m_impl->workers.emplace_back([impl = m_impl.get()]() { impl->workerLoop(); });
+}
+
+AsyncIOContext::~AsyncIOContext() {
+#if AT_IO_URING
+  if (m_impl->backend == Backend::IOUring) {
+    // The kernel may still write into request buffers, drain it before tearing the ring down.
+    // Nothing is resumed, the waiting coroutines are abandoned.
+    RequestList discard;
+    while (m_impl->ring.inFlight) {
+      const int err = m_impl->ring.enter(0, true);
+      // With the ring itself failing nothing more can be waited for
+      if (err < 0 && err != -EAGAIN && err != -EBUSY)
+        break;
+      m_impl->ring.reap(discard);
+      discard.take();
+    }
+    m_impl->ring.destroy();
+    return;
+  }
+#endif
+  {
+    std::lock_guard lk(m_impl->mutex);
+    m_impl->stopping = true;
+  }
+  m_impl->workCv.notify_all();
+  for (std::thread& worker : m_impl->workers)
+    worker.join();
+}
+
+AsyncIOContext::Backend AsyncIOContext::backend() const { return m_impl->backend; }
+
+size_t AsyncIOContext::outstanding() const { return m_impl->outstanding; }
+
+void AsyncIOContext::enqueue(AsyncIORequest& req) {
+  Impl& impl = *m_impl;
+  ++impl.outstanding;
+  req.iov.base = req.buf;
+  req.iov.len = size_t(req.len);
+
+  if (req.handle == -1) {
+    req.result = -1;
+    impl.ready.push(&req);
+    return;
+  }
+
+#if AT_IO_URING
+  if (impl.backend == Backend::IOUring) {
+    // Submission is deferred to process(), so everything queued before the next wait goes in one syscall
+    impl.pending.push(&req);
+    return;
+  }
+#endif
+
+  {
+    std::lock_guard lk(impl.mutex);
+    impl.work.push(&req);
+  }
+  impl.workCv.notify_one();
+}
+
+size_t AsyncIOContext::process(bool wait) {
+  Impl& impl = *m_impl;
+  RequestList finished;
+  AsyncIORequest* list = impl.ready.take();
+  while (list) {
+    AsyncIORequest* next = list->next;
+    finished.push(list);
+    list = next;
+  }
+  wait = wait && finished.empty();
+
+#if AT_IO_URING
+  if (impl.backend == Backend::IOUring) {
+    IOUring& ring = impl.ring;
+    while (!impl.pending.empty() && !ring.full())
+      ring.prepare(*impl.pending.pop());
+    int err = 0;
+    if (ring.queued || (wait && ring.inFlight))
+      err = ring.enter(ring.queued, wait);
+    if ((err == -EAGAIN || err == -EBUSY) && ring.inFlight) {
+      // Out of room until completions are reaped, the queued SQEs go in on a later pass
+      ring.reap(finished);
+      err = wait && finished.empty() ? ring.enter(0, true) : 0;
+    }
+    if (err < 0) {
+      // Nothing in flight will make room, or the ring itself failed
+      ring.failQueued(finished, err);
+      if (wait && finished.empty()) {
+        // Nothing can be waited for, the coroutines behind the requests in flight are abandoned
+        impl.outstanding -= ring.inFlight;
+        ring.inFlight = 0;
+      }
+    }
+    ring.reap(finished);
+  } else
+#endif
+  {
+    std::unique_lock lk(impl.mutex);
+    if (wait)
+      impl.doneCv.wait(lk, [&impl]() { return !impl.done.empty(); });
+    list = impl.done.take();
+    lk.unlock();
+    while (list) {
+      AsyncIORequest* next = list->next;
+      finished.push(list);
+      list = next;
+    }
+  }
+
+  // A resumed coroutine may reuse or free its requests, so the link is read before completing each one
+  size_t count = 0;
+  list = finished.take();
+  while (list) {
+    AsyncIORequest* next = list->next;
+    --impl.outstanding;
+    ++count;
+    AsyncIORequest::Batch* batch = list->batch;
+    if (--batch->remaining == 0)
+      batch->waiter.resume();
+    list = next;
+  }
+  return count;
+}
+
+void AsyncIOContext::run() {
+  while (m_impl->outstanding)
+    process(true);
+}
+
+size_t AsyncIOContext::poll() { return process(false); }
+
+void AsyncIOOp::await_suspend(std::coroutine_handle<> waiter) {
+  m_batch.waiter = waiter;
+  m_batch.remaining = 1;
+  m_req.batch = &m_batch;
+  m_ctx.enqueue(m_req);
+}
+
+void AsyncIOBatchOp::await_suspend(std::coroutine_handle<> waiter) {
+  m_batch.waiter = waiter;
+  m_batch.remaining = m_reqs.size();
+  for (AsyncIORequest& req : m_reqs) {
+    req.batch = &m_batch;
+    m_ctx.enqueue(req);
+  }
+}
+
+AsyncFileReader::AsyncFileReader(AsyncIOContext& ctx, std::string_view filename, bool globalErr)
+: m_ctx(ctx), m_globalErr(globalErr) {
+#if _WIN32
+  m_filename = utility::utf8ToWide(filename);
+#else
+  m_filename = filename;
+#endif
+  open();
+}
+
+AsyncFileReader::AsyncFileReader(AsyncIOContext& ctx, std::wstring_view filename, bool globalErr)
+: m_ctx(ctx), m_globalErr(globalErr) {
+#if _WIN32
+  m_filename = filename;
+#else
+  m_filename = utility::wideToUtf8(filename);
+#endif
+  open();
+}
+
+AsyncFileReader::~AsyncFileReader() {
+  if (isOpen())
+    close();
+}
+
+void AsyncFileReader::open() {
+#ifndef _WIN32
+  const int fd = ::open(m_filename.c_str(), O_RDONLY | O_CLOEXEC);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0) {
+    if (fd >= 0)
+      ::close(fd);
+    if (m_globalErr)
+      atError("File not found '{}'", m_filename);
+    m_hasError = true;
+    return;
+  }
+  m_handle = fd;
+  m_length = uint64_t(st.st_size);
+#else
+#if WINDOWS_STORE
+  HANDLE file = CreateFile2(m_filename.c_str(), GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, nullptr);
+#else
+  HANDLE file = CreateFileW(m_filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+#endif
+  if (file == INVALID_HANDLE_VALUE) {
+    std::string _filename = filename();
+    if (m_globalErr)
+      atError("File not found '{}'", _filename);
+    m_hasError = true;
+    return;
+  }
+  LARGE_INTEGER size;
+  GetFileSizeEx(file, &size);
+  m_handle = intptr_t(file);
+  m_length = uint64_t(size.QuadPart);
+#endif
+
+  // reset error
+  m_hasError = false;
+}
+
+void AsyncFileReader::close() {
+  if (!isOpen()) {
+    if (m_globalErr)
+      atError("Cannot close an unopened stream");
+    m_hasError = true;
+    return;
+  }
+
+#ifndef _WIN32
+  ::close(int(m_handle));
+#else
+  CloseHandle(HANDLE(m_handle));
+#endif
+  m_handle = -1;
+  m_length = 0;
+}
+
+AsyncFileWriter::AsyncFileWriter(AsyncIOContext& ctx, std::string_view filename, bool overwrite, bool globalErr)
+: m_ctx(ctx), m_globalErr(globalErr) {
+#if _WIN32
+  m_filename = utility::utf8ToWide(filename);
+#else
+  m_filename = filename;
+#endif
+  open(overwrite);
+}
+
+AsyncFileWriter::AsyncFileWriter(AsyncIOContext& ctx, std::wstring_view filename, bool overwrite, bool globalErr)
+: m_ctx(ctx), m_globalErr(globalErr) {
+#if _WIN32
+  m_filename = filename;
+#else
+  m_filename = utility::wideToUtf8(filename);
+#endif
+  open(overwrite);
+}
+
+AsyncFileWriter::~AsyncFileWriter() {
+  if (isOpen())
+    close();
+}
+
+void AsyncFileWriter::open(bool overwrite) {
+#ifndef _WIN32
+  const int fd = ::open(m_filename.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (overwrite ? O_TRUNC : 0), 0666);
+  if (fd < 0) {
+    if (m_globalErr)
+      atError("Unable to open file '{}'", m_filename);
+    m_hasError = true;
+    return;
+  }
+  m_handle = fd;
+#else
+#if WINDOWS_STORE
+  HANDLE file = CreateFile2(m_filename.c_str(), GENERIC_WRITE, FILE_SHARE_READ,
+                            overwrite ? CREATE_ALWAYS : OPEN_ALWAYS, nullptr);
+#else
+  HANDLE file = CreateFileW(m_filename.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                            overwrite ? CREATE_ALWAYS : OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+#endif
+  if (file == INVALID_HANDLE_VALUE) {
+    std::string _filename = filename();
+    if (m_globalErr)
+      atError("Unable to open file '{}'", _filename);
+    m_hasError = true;
+    return;
+  }
+  m_handle = intptr_t(file);
+#endif
+
+  // reset error
+  m_hasError = false;
+}
+
+void AsyncFileWriter::close() {
+  if (!isOpen()) {
+    if (m_globalErr)
+      atError("Cannot close an unopened stream");
+    m_hasError = true;
+    return;
+  }
+
+#ifndef _WIN32
+  ::close(int(m_handle));
+#else
+  CloseHandle(HANDLE(m_handle));
+#endif
+  m_handle = -1;
+}
+} // namespace athena::io
@@ -1,87 +1,302 @@
 #include "athena/Compression.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#if !defined(GEKKO) && !defined(__SWITCH__)
+#include <atomic>
+#include <thread>
+#endif
+
 #if AT_LZOKAY
 #include <lzokay.hpp>
 #endif
 
 #include <zlib.h>
+#include "athena/Utility.hpp"
+#include "LZ77/LZCopy.hpp"
 #include "LZ77/LZType10.hpp"
 #include "LZ77/LZType11.hpp"
 
 namespace athena::io::Compression {
 
-void zlibInitZStrm(const uint8_t* src, uint32_t srcLen, uint8_t* dst, uint32_t dstLen, z_stream& strm) {
-  strm.avail_in = srcLen;
-  strm.avail_out = dstLen;
-  strm.next_in = const_cast<Bytef*>(src);
-  strm.next_out = dst;
-  strm.zalloc = Z_NULL;
-  strm.zfree = Z_NULL;
-  strm.opaque = Z_NULL;
-}
-int32_t zlibInflate(z_stream& strm, int32_t bits) {
-  int32_t ret = inflateInit2(&strm, bits);
-  if (ret == Z_OK) {
-    ret = inflate(&strm, Z_FINISH);
-    if (ret == Z_STREAM_END) {
-      ret = strm.total_out;
-    }
+int32_t decompressZlib(const uint8_t* src, uint32_t srcLen, uint8_t* dst, uint32_t dstLen) {
+  return ZlibContext(Z_BEST_COMPRESSION, ZlibContext::Format::Auto).decompress({src, srcLen}, {dst, dstLen});
+}
+
+int32_t compressZlib(const uint8_t* src, uint32_t srcLen, uint8_t* dst, uint32_t dstLen) {
+  return ZlibContext(Z_BEST_COMPRESSION, ZlibContext::Format::Zlib).compress({src, srcLen}, {dst, dstLen});
+}
+
+ZlibContext::ZlibContext(int32_t level, Format format, Strategy strategy, int32_t windowBits)
+: m_deflate(std::make_unique<z_stream>())
+, m_inflate(std::make_unique<z_stream>())
+, m_level(level)
+, m_format(format)
+, m_strategy(strategy)
+, m_windowBits(windowBits) {}
+
+ZlibContext::~ZlibContext() {
+  if (m_deflateBits)
+    deflateEnd(m_deflate.get());
+  if (m_inflateBits)
+    inflateEnd(m_inflate.get());
+}
+
+bool ZlibContext::prepareDeflate() {
+  int bits = std::clamp(m_windowBits, 9, MAX_WBITS);
+  if (m_format == Format::Gzip)
+    bits |= 16;
+  else if (m_format == Format::Raw)
+    bits = -bits;
+
+  const bool sameParams = m_level == m_deflateLevel && m_strategy == m_deflateStrategy;
+  if (m_deflateBits == bits && sameParams)
+    return deflateReset(m_deflate.get()) == Z_OK;
+#if ZLIB_VERNUM >= 0x12c0
+  if (m_deflateBits == bits) {
+    // Nothing has been compressed since the reset, so this cannot produce output. Before 1.2.12 deflateParams
+    // flushes into the previous call's next_out even then, so older zlib recreates the state below instead.
+    deflateReset(m_deflate.get());
+    if (deflateParams(m_deflate.get(), m_level, int(m_strategy)) != Z_OK)
+      return false;
+    m_deflateLevel = m_level;
+    m_deflateStrategy = m_strategy;
+    return true;
+  }
+#endif
+
+  if (m_deflateBits) {
+    deflateEnd(m_deflate.get());
+    m_deflateBits = 0;
   }
-  return ret;
+  *m_deflate = {};
+  if (deflateInit2(m_deflate.get(), m_level, Z_DEFLATED, bits, 8, int(m_strategy)) != Z_OK)
+    return false;
+  m_deflateBits = bits;
+  m_deflateLevel = m_level;
+  m_deflateStrategy = m_strategy;
+  return true;
 }
-int32_t decompressZlib(const uint8_t* src, uint32_t srcLen, uint8_t* dst, uint32_t dstLen) {
-  z_stream strm = {};
-  zlibInitZStrm(src, srcLen, dst, dstLen, strm);
-
-  // 15 window bits, and the | 16 tells zlib to to detect if using gzip or zlib
-  int32_t ret = zlibInflate(strm, MAX_WBITS | 16);
-  if (ret != Z_STREAM_END) {
-    // Try again without gzip
-    zlibInitZStrm(src, srcLen, dst, dstLen, strm);
-    ret = zlibInflate(strm, MAX_WBITS);
-    if (ret == Z_STREAM_END) {
-      ret = strm.total_out;
-    }
+
+bool ZlibContext::prepareInflate() {
+  int bits = MAX_WBITS;
+  if (m_format == Format::Auto)
+    bits |= 32; // zlib tells gzip from zlib by the header, so each payload is inflated once
+  else if (m_format == Format::Gzip)
+    bits |= 16;
+  else if (m_format == Format::Raw)
+    bits = -bits;
+
+  if (m_inflateBits == bits)
+    return inflateReset(m_inflate.get()) == Z_OK;
+  if (m_inflateBits) {
+    // Same window size, only the header handling changes
+    if (inflateReset2(m_inflate.get(), bits) != Z_OK)
+      return false;
   } else {
-    ret = strm.total_out;
+    *m_inflate = {};
+    if (inflateInit2(m_inflate.get(), bits) != Z_OK)
+      return false;
   }
-  inflateEnd(&strm);
-  return ret;
+  m_inflateBits = bits;
+  return true;
 }
 
-int32_t compressZlib(const uint8_t* src, uint32_t srcLen, uint8_t* dst, uint32_t dstLen) {
-  z_stream strm = {};
-  strm.total_in = strm.avail_in = srcLen;
-  strm.total_out = strm.avail_out = dstLen;
-  strm.next_in = (Bytef*)src;
-  strm.next_out = (Bytef*)dst;
+int32_t ZlibContext::compress(std::span<const uint8_t> src, std::span<uint8_t> dst) {
+  if (!prepareDeflate())
+    return Z_STREAM_ERROR;
+  if (!m_dictionary.empty() &&
+      deflateSetDictionary(m_deflate.get(), m_dictionary.data(), uInt(m_dictionary.size())) != Z_OK)
+    return Z_STREAM_ERROR;
+
+  z_stream& strm = *m_deflate;
+  strm.next_in = const_cast<Bytef*>(src.data());
+  strm.avail_in = uInt(src.size());
+  strm.next_out = dst.data();
+  strm.avail_out = uInt(dst.size());
+  const int ret = deflate(&strm, Z_FINISH);
+  if (ret != Z_STREAM_END)
+    return ret == Z_OK ? Z_BUF_ERROR : ret;
+  return int32_t(strm.total_out);
+}
 
-  strm.zalloc = Z_NULL;
-  strm.zfree = Z_NULL;
-  strm.opaque = Z_NULL;
+int32_t ZlibContext::decompress(std::span<const uint8_t> src, std::span<uint8_t> dst) {
+  if (!prepareInflate())
+    return Z_STREAM_ERROR;
+
+  // zlib refuses a null output even when there is nothing to write
+  uint8_t empty;
+  z_stream& strm = *m_inflate;
+  strm.next_in = const_cast<Bytef*>(src.data());
+  strm.avail_in = uInt(src.size());
+  strm.next_out = dst.empty() ? &empty : dst.data();
+  strm.avail_out = uInt(dst.size());
+
+  // Raw streams do not ask for the dictionary, zlib streams ask once their header has been read
+  const bool haveDictionary = !m_dictionary.empty();
+  if (haveDictionary && m_format == Format::Raw &&
+      inflateSetDictionary(&strm, m_dictionary.data(), uInt(m_dictionary.size())) != Z_OK)
+    return Z_STREAM_ERROR;
+  int ret = inflate(&strm, Z_FINISH);
+  if (ret == Z_NEED_DICT && haveDictionary) {
+    // Z_DATA_ERROR when the stream was compressed with a different dictionary
+    ret = inflateSetDictionary(&strm, m_dictionary.data(), uInt(m_dictionary.size()));
+    if (ret == Z_OK)
+      ret = inflate(&strm, Z_FINISH);
+  }
+  if (ret != Z_STREAM_END)
+    return ret == Z_NEED_DICT ? Z_DATA_ERROR : (ret == Z_OK ? Z_BUF_ERROR : ret);
+  return int32_t(strm.total_out);
+}
 
-  int32_t err = -1;
-  int32_t ret = -1;
+namespace {
+constexpr uint32_t DictionaryDmerSize = 8;
+constexpr uint32_t DictionaryHashBits = 20;
 
-  err = deflateInit(&strm, Z_BEST_COMPRESSION);
+uint32_t dmerHash(const uint8_t* p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return uint32_t((v * 0x9E3779B97F4A7C15ull) >> (64 - DictionaryHashBits));
+}
 
-  if (err == Z_OK) {
-    err = deflate(&strm, Z_FINISH);
+std::vector<uint8_t> trainDictionary(const std::vector<std::vector<uint8_t>>& samples, uint32_t maxSize,
+                                     uint32_t segmentSize) {
+  // Count the samples each substring occurs in, indexing the substrings of all samples as one corpus
+  std::vector<uint32_t> frequency(1u << DictionaryHashBits);
+  std::vector<uint32_t> lastSample(1u << DictionaryHashBits, UINT32_MAX);
+  std::vector<uint64_t> sampleStart(samples.size() + 1);
+  for (uint32_t s = 0; s < samples.size(); ++s) {
+    const std::vector<uint8_t>& sample = samples[s];
+    const uint32_t dmers = sample.size() < DictionaryDmerSize ? 0 : uint32_t(sample.size() - DictionaryDmerSize + 1);
+    sampleStart[s + 1] = sampleStart[s] + dmers;
+    for (uint32_t i = 0; i < dmers; ++i) {
+      const uint32_t h = dmerHash(sample.data() + i);
+      if (lastSample[h] != s) {
+        lastSample[h] = s;
+        ++frequency[h];
+      }
+    }
+  }
 
-    if (err == Z_STREAM_END)
-      ret = strm.total_out;
-    else {
-      deflateEnd(&strm);
-      return err;
+  // Substrings unique to one sample are noise, unless there is only the one
+  if (samples.size() > 1)
+    for (uint32_t& f : frequency)
+      f = f > 1 ? f : 0;
+
+  struct Segment {
+    uint64_t score;
+    uint32_t sample;
+    uint32_t pos;
+    uint32_t length;
+  };
+  std::vector<Segment> segments;
+  std::vector<uint16_t> active(1u << DictionaryHashBits);
+  const uint64_t total = sampleStart.back();
+  const uint32_t segmentCount = std::max(1u, maxSize / segmentSize);
+  const uint64_t epochSize = std::max<uint64_t>(1, (total + segmentCount - 1) / segmentCount);
+
+  uint32_t s = 0;
+  for (uint64_t epochBegin = 0; epochBegin < total; epochBegin += epochSize) {
+    const uint64_t epochEnd = std::min(total, epochBegin + epochSize);
+    Segment best{0, 0, 0, 0};
+
+    // Slide a segment over the part of each sample inside the epoch, scoring the distinct substrings in it
+    while (sampleStart[s + 1] <= epochBegin)
+      ++s;
+    for (uint32_t t = s; t < samples.size() && sampleStart[t] < epochEnd; ++t) {
+      const uint8_t* data = samples[t].data();
+      const uint32_t length = uint32_t(std::min<size_t>(samples[t].size(), segmentSize));
+      const uint32_t dmers = uint32_t(sampleStart[t + 1] - sampleStart[t]);
+      if (dmers == 0)
+        continue;
+      const uint32_t window = length - DictionaryDmerSize + 1;
+      const uint32_t last = dmers - window;
+      // Window starts in [lo, hi), never empty since the sample overlaps the epoch
+      const uint32_t lo = uint32_t(std::min<uint64_t>(std::max(epochBegin, sampleStart[t]) - sampleStart[t], last));
+      const uint32_t hi = uint32_t(std::min<uint64_t>(epochEnd - sampleStart[t], last + 1));
+
+      uint64_t score = 0;
+      const auto add = [&](uint32_t i) {
+        const uint32_t h = dmerHash(data + i);
+        if (active[h]++ == 0)
+          score += frequency[h];
+      };
+      const auto remove = [&](uint32_t i) {
+        const uint32_t h = dmerHash(data + i);
+        if (--active[h] == 0)
+          score -= frequency[h];
+      };
+
+      for (uint32_t i = lo; i < lo + window; ++i)
+        add(i);
+      for (uint32_t pos = lo;; ++pos) {
+        if (score > best.score)
+          best = {score, t, pos, length};
+        if (pos + 1 == hi)
+          break;
+        remove(pos);
+        add(pos + window);
+      }
+      for (uint32_t i = hi - 1; i < hi - 1 + window; ++i)
+        remove(i);
     }
-  } else {
-    deflateEnd(&strm);
-    return err;
+
+    if (best.score == 0)
+      continue;
+
+    // Covered substrings do not count towards later segments
+    for (uint32_t i = 0; i + DictionaryDmerSize <= best.length; ++i)
+      frequency[dmerHash(samples[best.sample].data() + best.pos + i)] = 0;
+    segments.push_back(best);
   }
 
-  deflateEnd(&strm);
+  std::stable_sort(segments.begin(), segments.end(),
+                   [](const Segment& a, const Segment& b) { return a.score < b.score; });
+  std::vector<uint8_t> dictionary;
+  for (const Segment& segment : segments) {
+    const uint8_t* data = samples[segment.sample].data() + segment.pos;
+    dictionary.insert(dictionary.end(), data, data + segment.length);
+  }
+  if (dictionary.size() > maxSize)
+    dictionary.erase(dictionary.begin(), dictionary.end() - maxSize);
+  return dictionary;
+}
+} // namespace
+
+std::vector<uint8_t> trainZlibDictionary(const std::vector<std::vector<uint8_t>>& samples, uint32_t maxSize) {
+  maxSize = std::min(maxSize, 1u << MAX_WBITS);
+
+  // Short segments suit samples that only share fragments, long ones samples that share whole runs. Train with
+  // each and keep whichever compresses a spread of the samples best.
+  constexpr uint32_t EvaluationSamples = 256;
+  const size_t step = std::max<size_t>(1, samples.size() / EvaluationSamples);
+  ZlibContext ctx(6, ZlibContext::Format::Raw);
+  std::vector<uint8_t> out;
+  std::vector<uint8_t> best;
+  uint64_t bestSize = UINT64_MAX;
+  for (const uint32_t segmentSize : {64u, 256u, 1024u, 4096u}) {
+    std::vector<uint8_t> dictionary = trainDictionary(samples, maxSize, segmentSize);
+    ctx.setDictionary(dictionary);
+    uint64_t size = 0;
+    for (size_t i = 0; i < samples.size(); i += step) {
+      out.resize(ctx.compressBound(uint32_t(samples[i].size())));
+      const int32_t len = ctx.compress(samples[i], out);
+      size += len > 0 ? uint64_t(len) : samples[i].size();
+    }
+    if (size < bestSize) {
+      bestSize = size;
+      best = std::move(dictionary);
+    }
+  }
+  return best;
+}
 
-  return ret;
+uint32_t ZlibContext::compressBound(uint32_t srcLen) {
+  if (!prepareDeflate())
+    return 0;
+  return uint32_t(deflateBound(m_deflate.get(), srcLen));
 }
 
 #if AT_LZOKAY
@@ -97,213 +312,347 @@ atInt32 decompressLZO(const atUint8* source, const atInt32 sourceSize, atUint8*
 // src points to the yaz0 source data (to the "real" source data, not at the header!)
 // dst points to a buffer uncompressedSize bytes large (you get uncompressedSize from
 // the second 4 bytes in the Yaz0 header).
-uint32_t yaz0Decode(const uint8_t* src, uint8_t* dst, uint32_t uncompressedSize) {
-  uint32_t srcPlace = 0, dstPlace = 0; // current read/write positions
-
-  int32_t validBitCount = 0; // number of valid bits left in "code" byte
-  uint8_t currCodeByte;
-
-  while (dstPlace < uncompressedSize) {
-    // read new "code" byte if the current one is used up
-    if (validBitCount == 0) {
-      currCodeByte = src[srcPlace];
-      ++srcPlace;
-      validBitCount = 8;
+uint32_t yaz0Decode(const uint8_t* src, uint32_t srcSize, uint8_t* dst, uint32_t uncompressedSize) {
+  const uint8_t* in = src;
+  const uint8_t* const inEnd = src + srcSize;
+  uint8_t* out = dst;
+  uint8_t* const outEnd = dst + uncompressedSize;
+
+  while (out < outEnd) {
+    // read new "code" byte
+    if (in == inEnd)
+      return 0;
+    uint8_t code = *in++;
+
+    if (code == 0xFF && inEnd - in >= 8 && outEnd - out >= 8) {
+      // eight straight copies
+      std::memcpy(out, in, 8);
+      in += 8;
+      out += 8;
+      continue;
     }
 
-    if ((currCodeByte & 0x80) != 0) {
-      // straight copy
-      dst[dstPlace] = src[srcPlace];
-      dstPlace++;
-      srcPlace++;
-    } else {
-      // RLE part
-      uint8_t byte1 = src[srcPlace];
-      uint8_t byte2 = src[srcPlace + 1];
-      srcPlace += 2;
+    for (uint32_t bit = 0; bit < 8 && out < outEnd; ++bit, code <<= 1) {
+      if ((code & 0x80) != 0) {
+        // straight copy
+        if (in == inEnd)
+          return 0;
+        *out++ = *in++;
+        continue;
+      }
 
-      uint32_t dist = ((byte1 & 0xF) << 8) | byte2;
-      uint32_t copySource = dstPlace - (dist + 1);
+      // RLE part
+      if (inEnd - in < 2)
+        return 0;
+      const uint8_t byte1 = in[0];
+      const uint8_t byte2 = in[1];
+      in += 2;
 
+      const uint32_t dist = (((byte1 & 0xF) << 8) | byte2) + 1;
       uint32_t numBytes = byte1 >> 4;
-
       if (numBytes == 0) {
-        numBytes = src[srcPlace] + 0x12;
-        srcPlace++;
+        if (in == inEnd)
+          return 0;
+        numBytes = *in++ + 0x12;
       } else
         numBytes += 2;
 
-      // copy run
-      for (uint32_t i = 0; i < numBytes; ++i) {
-        dst[dstPlace] = dst[copySource];
-        copySource++;
-        dstPlace++;
-      }
-    }
+      // The run has to start inside the data decoded so far and end inside the output
+      if (dist > uint32_t(out - dst) || numBytes > uint32_t(outEnd - out))
+        return 0;
 
-    // use next bit from "code" byte
-    currCodeByte <<= 1;
-    validBitCount -= 1;
+      if (uint32_t(outEnd - out) - numBytes >= LZCopySlack)
+        lzCopyMatch(out, dist, numBytes);
+      else
+        lzCopyMatchExact(out, dist, numBytes);
+      out += numBytes;
+    }
   }
 
-  return dstPlace;
+  return uncompressedSize;
 }
 
-// Yaz0 encode
-typedef struct {
-  uint32_t srcPos, dstPos;
-} yaz0_Ret;
-
-uint32_t simpleEnc(const uint8_t* src, int32_t size, int32_t pos, uint32_t* pMatchPos);
-uint32_t nintendoEnc(const uint8_t* src, int32_t size, int32_t pos, uint32_t* pMatchPos);
+uint32_t yaz0Decode(const uint8_t* src, uint8_t* dst, uint32_t uncompressedSize) {
+  // No stream decoding to uncompressedSize bytes is longer than one byte per output byte plus the code bytes
+  return yaz0Decode(src, yaz0EncodeBound(uncompressedSize), dst, uncompressedSize);
+}
 
-uint32_t yaz0Encode(const uint8_t* src, uint32_t srcSize, uint8_t* data) {
-  yaz0_Ret r = {0, 0};
-  int32_t pos = 0;
-  uint8_t dst[24]; // 8 codes * 3 bytes maximum
-  uint32_t dstSize = 0;
-  uint32_t i;
+// Yaz0 encode
+namespace {
+constexpr uint32_t Yaz0Window = 0x1000;
+constexpr uint32_t Yaz0MaxMatch = 0xFF + 0x12;
+constexpr uint32_t Yaz0HashBits = 15;
+
+uint32_t yaz0Hash(const uint8_t* p) {
+  const uint32_t v = (uint32_t(p[0]) << 16) | (uint32_t(p[1]) << 8) | p[2];
+  return (v * 2654435761u) >> (32 - Yaz0HashBits);
+}
 
-  uint32_t validBitCount = 0; // number of valid bits left in "code" byte
-  uint8_t currCodeByte = 0;
+uint32_t matchLength(const uint8_t* a, const uint8_t* b, uint32_t maxLen) {
+  uint32_t len = 0;
+  while (len + 8 <= maxLen) {
+    uint64_t x, y;
+    memcpy(&x, a + len, 8);
+    memcpy(&y, b + len, 8);
+    if (x != y)
+      break;
+    len += 8;
+  }
+  while (len < maxLen && a[len] == b[len])
+    ++len;
+  return len;
+}
 
-  while (r.srcPos < srcSize) {
-    uint32_t numBytes;
-    uint32_t matchPos;
-    numBytes = nintendoEnc(src, srcSize, r.srcPos, &matchPos);
+// Inputs larger than this are split into chunks of this size when compressing on several threads
+constexpr uint32_t ParallelChunkSize = 0x40000;
+
+// Calls fn(i) for every i in [0, count) on up to threadCount threads, 0 meaning one per hardware thread
+template <class Fn>
+void parallelFor(uint32_t count, uint32_t threadCount, Fn&& fn) {
+#if !defined(GEKKO) && !defined(__SWITCH__)
+  if (threadCount == 0)
+    threadCount = std::max(1u, std::thread::hardware_concurrency());
+  threadCount = std::min(threadCount, count);
+  if (threadCount > 1) {
+    std::atomic<uint32_t> next{0};
+    auto worker = [&]() {
+      for (uint32_t i = next++; i < count; i = next++)
+        fn(i);
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (uint32_t t = 1; t < threadCount; ++t)
+      threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads)
+      thread.join();
+    return;
+  }
+#endif
+  for (uint32_t i = 0; i < count; ++i)
+    fn(i);
+}
 
-    if (numBytes < 3) {
-      // straight copy
-      dst[r.dstPos] = src[r.srcPos];
-      r.dstPos++;
-      r.srcPos++;
-      // set flag for straight copy
-      currCodeByte |= (0x80 >> validBitCount);
-    } else {
-      // RLE part
-      uint32_t dist = r.srcPos - matchPos - 1;
-      uint8_t byte1, byte2, byte3;
-
-      if (numBytes >= 0x12) // 3 byte encoding
-      {
-        byte1 = 0 | (dist >> 8);
-        byte2 = dist & 0xff;
-        dst[r.dstPos++] = byte1;
-        dst[r.dstPos++] = byte2;
-
-        // maximum runlength for 3 byte encoding
-        if (numBytes > 0xff + 0x12)
-          numBytes = 0xff + 0x12;
-
-        byte3 = numBytes - 0x12;
-        dst[r.dstPos++] = byte3;
-      } else // 2 byte encoding
-      {
-        byte1 = ((numBytes - 2) << 4) | (dist >> 8);
-        byte2 = dist & 0xff;
-        dst[r.dstPos++] = byte1;
-        dst[r.dstPos++] = byte2;
+// Yaz0 and LZ77 both group operations in eights behind a flag byte, so a separately encoded chunk that
+// ends in a partial group cannot just be appended to the next one. This re-flows the operations of each
+// chunk into a single run of groups.
+class BlockPacker {
+public:
+  explicit BlockPacker(uint8_t* dst) : m_dst(dst) {}
+
+  // opSize(bit, lead) returns the encoded size of an operation from its flag bit and first byte
+  template <class OpSize>
+  void append(const uint8_t* src, uint32_t len, OpSize opSize) {
+    const uint8_t* const end = src + len;
+    while (src < end) {
+      const uint8_t flags = *src++;
+      for (uint32_t bit = 0; bit < 8 && src < end; ++bit) {
+        const bool set = (flags & (0x80 >> bit)) != 0;
+        const uint32_t size = opSize(set, *src);
+        if (m_ops == 0) {
+          m_flagPos = m_pos++;
+          m_dst[m_flagPos] = 0;
+        }
+        if (set)
+          m_dst[m_flagPos] |= 0x80 >> m_ops;
+        std::memcpy(m_dst + m_pos, src, size);
+        m_pos += size;
+        src += size;
+        m_ops = (m_ops + 1) & 7;
       }
-
-      r.srcPos += numBytes;
     }
+  }
 
-    validBitCount++;
-
-    // write eight codes
-    if (validBitCount == 8) {
-      data[pos] = currCodeByte;
-      pos++;
-
-      for (i = 0; i < /*=*/r.dstPos; pos++, i++)
-        data[pos] = dst[i];
+  uint32_t size() const { return m_pos; }
+
+private:
+  uint8_t* m_dst;
+  uint32_t m_pos = 0;
+  uint32_t m_flagPos = 0;
+  uint32_t m_ops = 0;
+};
+
+// Splits srcSize bytes into chunks, encodes them with encodeRange(begin, end, dst) on up to threadCount threads
+// and joins the results at dst. The last chunk takes the remainder, so none of them is tiny.
+template <class EncodeRange, class OpSize>
+uint32_t encodeChunks(uint32_t srcSize, uint8_t* dst, uint32_t threadCount, EncodeRange encodeRange,
+                      OpSize opSize) {
+  const uint32_t chunkCount = std::max(1u, srcSize / ParallelChunkSize);
+  // Room for the flag bytes of one chunk, the last one may be up to twice as large
+  const size_t slack = ParallelChunkSize / 8 + 1;
+  std::unique_ptr<uint8_t[]> chunks(new uint8_t[srcSize + slack * (chunkCount + 1)]);
+  std::vector<uint32_t> chunkSizes(chunkCount);
+
+  parallelFor(chunkCount, threadCount, [&](uint32_t i) {
+    const uint32_t begin = i * ParallelChunkSize;
+    const uint32_t end = i + 1 == chunkCount ? srcSize : begin + ParallelChunkSize;
+    chunkSizes[i] = encodeRange(begin, end, chunks.get() + begin + slack * i);
+  });
+
+  BlockPacker packer(dst);
+  for (uint32_t i = 0; i < chunkCount; ++i)
+    packer.append(chunks.get() + i * ParallelChunkSize + slack * i, chunkSizes[i], opSize);
+  return packer.size();
+}
+} // namespace
+
+void Yaz0Encoder::insertUpTo(const uint8_t* src, uint32_t end) {
+  end = std::min(end, m_insertEnd);
+  for (; m_inserted < end; ++m_inserted) {
+    const uint32_t h = yaz0Hash(src + m_inserted);
+    m_prev[m_inserted & (Yaz0Window - 1)] = m_head[h];
+    m_head[h] = int32_t(m_inserted);
+  }
+}
 
-      dstSize += r.dstPos + 1;
+// Finds the earliest longest match in the window, exactly like the original scan of every previous position
+uint32_t Yaz0Encoder::findMatch(const uint8_t* src, uint32_t size, uint32_t pos, uint32_t& matchPos) {
+  insertUpTo(src, pos);
+  matchPos = 0;
+  if (size - pos < 3)
+    return 1;
+
+  // Nintendo's encoder compares lengths past the format's maximum, so the exact level has to as well
+  const bool exact = m_level == Level::Nintendo;
+  const uint32_t maxLen = exact ? size - pos : std::min(size - pos, Yaz0MaxMatch);
+  const uint32_t chainLimit = m_level == Level::Fast ? 8 : (m_level == Level::Normal ? 64 : Yaz0Window);
+  const uint32_t windowStart = pos > Yaz0Window ? pos - Yaz0Window : 0;
+
+  // Gather the chain nearest first, then measure farthest first so ties go to the earliest position
+  m_candidates.clear();
+  for (int32_t c = m_head[yaz0Hash(src + pos)]; c >= 0 && uint32_t(c) >= windowStart; c = m_prev[c & (Yaz0Window - 1)]) {
+    m_candidates.push_back(uint32_t(c));
+    if (m_candidates.size() == chainLimit)
+      break;
+  }
 
-      currCodeByte = 0;
-      validBitCount = 0;
-      r.dstPos = 0;
+  uint32_t numBytes = 1;
+  for (auto it = m_candidates.rbegin(); it != m_candidates.rend(); ++it) {
+    const uint32_t c = *it;
+    // Only a candidate that also matches at the current best length can beat it
+    if (src[c + numBytes] != src[pos + numBytes])
+      continue;
+    const uint32_t len = matchLength(src + c, src + pos, maxLen);
+    if (len > numBytes) {
+      numBytes = len;
+      matchPos = c;
+      if (numBytes == maxLen)
+        break;
     }
   }
 
-  if (validBitCount > 0) {
-    data[pos] = currCodeByte;
-    pos++;
-
-    for (i = 0; i < /*=*/r.dstPos; pos++, i++)
-      data[pos] = dst[i];
-
-    dstSize += r.dstPos + 1;
-
-    currCodeByte = 0;
-    validBitCount = 0;
-    r.dstPos = 0;
-  }
+  if (numBytes < 3)
+    numBytes = 1;
+  return numBytes;
+}
 
-  return dstSize;
+void Yaz0Encoder::reset(uint32_t start) {
+  m_head.assign(size_t(1) << Yaz0HashBits, -1);
+  m_prev.assign(Yaz0Window, -1);
+  m_candidates.reserve(Yaz0Window);
+  m_inserted = start - std::min(start, Yaz0Window);
+  m_insertEnd = 0;
+  m_haveNext = false;
 }
 
-// a lookahead encoding scheme for ngc Yaz0
-uint32_t nintendoEnc(const uint8_t* src, int32_t size, int32_t pos, uint32_t* pMatchPos) {
-  uint32_t numBytes = 1;
-  static uint32_t numBytes1;
-  static uint32_t matchPos;
-  static int32_t prevFlag = 0;
-
-  // if prevFlag is set, it means that the previous position was determined by look-ahead try.
-  // so just use it. this is not the best optimization, but nintendo's choice for speed.
-  if (prevFlag == 1) {
-    *pMatchPos = matchPos;
-    prevFlag = 0;
-    return numBytes1;
+uint32_t Yaz0Encoder::nextOp(const uint8_t* src, uint32_t size, uint32_t pos, uint32_t& matchPos) {
+  if (m_haveNext) {
+    // the previous position was determined by look-ahead try, so just use it
+    m_haveNext = false;
+    matchPos = m_nextMatchPos;
+    return m_nextBytes;
   }
 
-  prevFlag = 0;
-  numBytes = simpleEnc(src, size, pos, &matchPos);
-  *pMatchPos = matchPos;
-
-  // if this position is RLE encoded, then compare to copying 1 byte and next position(pos+1) encoding
-  if (numBytes >= 3) {
-    numBytes1 = simpleEnc(src, size, pos + 1, &matchPos);
-
-    // if the next position encoding is +2 longer than current position, choose it.
-    // this does not guarantee the best optimization, but fairly good optimization with speed.
-    if (numBytes1 >= numBytes + 2) {
-      numBytes = 1;
-      prevFlag = 1;
+  m_insertEnd = size >= 3 ? size - 2 : 0;
+  const uint32_t numBytes = findMatch(src, size, pos, matchPos);
+
+  // if this position is RLE encoded, then compare to copying 1 byte and next position(pos+1) encoding.
+  // if the next position encoding is +2 longer than current position, choose it.
+  // this does not guarantee the best optimization, but nintendo's choice for speed.
+  if (m_level != Level::Fast && numBytes >= 3) {
+    m_nextBytes = findMatch(src, size, pos + 1, m_nextMatchPos);
+    if (m_nextBytes >= numBytes + 2) {
+      m_haveNext = true;
+      return 1;
     }
   }
-
   return numBytes;
 }
 
-// simple and straight encoding scheme for Yaz0
-uint32_t simpleEnc(const uint8_t* src, int32_t size, int32_t pos, uint32_t* pMatchPos) {
-  int startPos = pos - 0x1000, j, i;
-  uint32_t numBytes = 1;
-  uint32_t matchPos = 0;
+void Yaz0Encoder::slide(uint32_t shift) {
+  // Positions that fell out of the buffer end their chains, the ring slots stay put since shift is a whole window
+  const auto rebase = [shift](int32_t& pos) { pos = pos >= int32_t(shift) ? pos - int32_t(shift) : -1; };
+  for (int32_t& pos : m_head)
+    rebase(pos);
+  for (int32_t& pos : m_prev)
+    rebase(pos);
+  m_inserted -= shift;
+  m_nextMatchPos -= shift;
+}
 
-  if (startPos < 0)
-    startPos = 0;
+uint32_t Yaz0Encoder::encode(const uint8_t* src, uint32_t begin, uint32_t end, uint8_t* data) {
+  reset(begin);
 
-  for (i = startPos; i < pos; i++) {
-    for (j = 0; j < size - pos; j++) {
-      if (src[i + j] != src[j + pos])
-        break;
+  uint32_t srcPos = begin;
+  uint32_t dstPos = 0;
+  uint32_t codePos = 0;
+  uint32_t validBitCount = 0; // number of codes in the current group
+
+  while (srcPos < end) {
+    if (validBitCount == 0) {
+      codePos = dstPos++;
+      data[codePos] = 0;
     }
 
-    if ((uint32_t)j > numBytes) {
-      numBytes = j;
-      matchPos = i;
+    uint32_t matchPos;
+    uint32_t numBytes = nextOp(src, end, srcPos, matchPos);
+
+    if (numBytes < 3) {
+      // straight copy
+      data[dstPos++] = src[srcPos++];
+      // set flag for straight copy
+      data[codePos] |= (0x80 >> validBitCount);
+    } else {
+      // RLE part
+      const uint32_t dist = srcPos - matchPos - 1;
+
+      if (numBytes >= 0x12) {
+        // 3 byte encoding, clamped to the maximum runlength
+        numBytes = std::min(numBytes, Yaz0MaxMatch);
+        data[dstPos++] = uint8_t(dist >> 8);
+        data[dstPos++] = uint8_t(dist & 0xff);
+        data[dstPos++] = uint8_t(numBytes - 0x12);
+      } else {
+        // 2 byte encoding
+        data[dstPos++] = uint8_t(((numBytes - 2) << 4) | (dist >> 8));
+        data[dstPos++] = uint8_t(dist & 0xff);
+      }
+
+      srcPos += numBytes;
     }
+
+    if (++validBitCount == 8)
+      validBitCount = 0;
   }
 
-  *pMatchPos = matchPos;
+  return dstPos;
+}
 
-  if (numBytes == 2)
-    numBytes = 1;
+uint32_t yaz0Encode(const uint8_t* src, uint32_t srcSize, uint8_t* data) { return Yaz0Encoder().encode(src, srcSize, data); }
 
-  return numBytes;
+uint32_t yaz0EncodeBound(uint32_t srcSize) { return srcSize + (srcSize + 7) / 8; }
+
+uint32_t yaz0Encode(const uint8_t* src, uint32_t srcSize, uint8_t* data, uint32_t threadCount,
+                    Yaz0Encoder::Level level) {
+  if (threadCount == 1 || srcSize < ParallelChunkSize * 2)
+    return Yaz0Encoder(level).encode(src, srcSize, data);
+
+  // A set code bit is a literal, otherwise the match length nibble tells the 2 and 3 byte forms apart
+  const auto encodeRange = [src, level](uint32_t begin, uint32_t end, uint8_t* dst) {
+    return Yaz0Encoder(level).encode(src, begin, end, dst);
+  };
+  const auto opSize = [](bool bit, uint8_t lead) -> uint32_t { return bit ? 1 : ((lead >> 4) == 0 ? 3 : 2); };
+  return encodeChunks(srcSize, data, threadCount, encodeRange, opSize);
 }
 
 uint32_t decompressLZ77(const uint8_t* src, uint32_t srcLen, uint8_t** dst) {
@@ -314,11 +663,179 @@ uint32_t decompressLZ77(const uint8_t* src, uint32_t srcLen, uint8_t** dst) {
   return LZType10(2).decompress(src, dst, srcLen);
 }
 
-uint32_t compressLZ77(const uint8_t* src, uint32_t srcLen, uint8_t** dst, bool extended) {
+uint32_t decompressedLZ77Size(std::span<const uint8_t> src) {
+  uint32_t size = 0;
+  if (!src.empty() && src[0] == 0x11)
+    LZType11().readHeader(src, size);
+  else
+    LZType10(2).readHeader(src, size);
+  return size;
+}
+
+uint32_t decompressLZ77Into(std::span<const uint8_t> src, std::span<uint8_t> dst) {
+  if (!src.empty() && src[0] == 0x11)
+    return LZType11().decompressInto(src, dst);
+
+  return LZType10(2).decompressInto(src, dst);
+}
+
+namespace {
+uint32_t compressLZ77Parallel(const LZBase& lz, const uint8_t* src, uint32_t srcLen, uint8_t** dst,
+                              uint32_t threadCount) {
+  std::unique_ptr<uint8_t[]> out(new uint8_t[lz.compressBound(srcLen)]);
+  const uint32_t headerSize = lz.writeHeader(out.get(), srcLen);
+
+  // A set flag bit is a match, whose size depends on the format
+  const auto encodeRange = [&lz, src](uint32_t begin, uint32_t end, uint8_t* chunk) {
+    return lz.encodeRange(src, begin, end, chunk);
+  };
+  const auto opSize = [&lz](bool bit, uint8_t lead) -> uint32_t { return bit ? lz.matchSize(lead) : 1; };
+  uint32_t outLen = headerSize + encodeChunks(srcLen, out.get() + headerSize, threadCount, encodeRange, opSize);
+  while (outLen % 4)
+    out[outLen++] = 0;
+
+  *dst = out.release();
+  return outLen;
+}
+} // namespace
+
+uint32_t compressLZ77(const uint8_t* src, uint32_t srcLen, uint8_t** dst, bool extended, uint32_t threadCount,
+                      LZBase::Level level) {
+  std::unique_ptr<LZBase> lz;
+  if (extended)
+    lz = std::make_unique<LZType11>();
+  else
+    lz = std::make_unique<LZType10>(2);
+  lz->setLevel(level);
+
+  if (threadCount != 1 && srcLen >= ParallelChunkSize * 2)
+    return compressLZ77Parallel(*lz, src, srcLen, dst, threadCount);
+
+  return lz->compress(src, dst, srcLen);
+}
+
+uint32_t compressLZ77Bound(uint32_t srcLen, bool extended, LZBase::Level level) {
+  std::unique_ptr<LZBase> lz;
   if (extended)
-    return LZType11().compress(src, dst, srcLen);
+    lz = std::make_unique<LZType11>();
+  else
+    lz = std::make_unique<LZType10>(2);
+  lz->setLevel(level);
+  return lz->compressBound(srcLen);
+}
+
+uint32_t compressLZ77Into(std::span<const uint8_t> src, std::span<uint8_t> dst, LZBase& scratch) {
+  return scratch.compressInto(src, dst);
+}
+
+int32_t compressZlibParallel(const uint8_t* src, uint32_t srcLen, uint8_t* dst, uint32_t dstLen, uint32_t threadCount,
+                             int32_t level, ZlibFormat format) {
+#if defined(GEKKO) || defined(__SWITCH__)
+  // Without threads the blocks would only cost ratio
+  threadCount = 1;
+#endif
+  if (threadCount == 1 || srcLen < ParallelChunkSize * 2)
+    return ZlibContext(level, format).compress({src, srcLen}, {dst, dstLen});
+
+  constexpr uint32_t DictionarySize = 1 << MAX_WBITS;
+  const bool gzip = format == ZlibFormat::Gzip;
+  const bool raw = format == ZlibFormat::Raw;
+
+  struct Block {
+    std::unique_ptr<uint8_t[]> data;
+    uint32_t size = 0;
+    uLong check = 0;
+    bool ok = false;
+  };
+  const uint32_t blockCount = srcLen / ParallelChunkSize;
+  std::vector<Block> blocks(blockCount);
+
+  parallelFor(blockCount, threadCount, [&](uint32_t i) {
+    Block& block = blocks[i];
+    const uint32_t begin = i * ParallelChunkSize;
+    const uint32_t end = i + 1 == blockCount ? srcLen : begin + ParallelChunkSize;
+    const bool last = i + 1 == blockCount;
+
+    // Raw deflate, the header and trailer are written once around all blocks
+    z_stream strm = {};
+    if (deflateInit2(&strm, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+      return;
+    if (begin != 0) {
+      const uint32_t dictionary = std::min(begin, DictionarySize);
+      deflateSetDictionary(&strm, src + begin - dictionary, dictionary);
+    }
 
-  return LZType10(2).compress(src, dst, srcLen);
+    // The sync flush adds an empty stored block on top of the bound
+    const uint32_t bound = uint32_t(deflateBound(&strm, end - begin)) + 8;
+    block.data.reset(new uint8_t[bound]);
+    strm.next_in = const_cast<Bytef*>(src + begin);
+    strm.avail_in = end - begin;
+    strm.next_out = block.data.get();
+    strm.avail_out = bound;
+    const int ret = deflate(&strm, last ? Z_FINISH : Z_SYNC_FLUSH);
+    block.ok = (last ? ret == Z_STREAM_END : ret == Z_OK) && strm.avail_in == 0 && strm.avail_out != 0;
+    block.size = bound - strm.avail_out;
+    deflateEnd(&strm);
+
+    if (gzip)
+      block.check = crc32(crc32(0, Z_NULL, 0), src + begin, end - begin);
+    else if (!raw)
+      block.check = adler32(adler32(0, Z_NULL, 0), src + begin, end - begin);
+  });
+
+  uint8_t header[10];
+  uint32_t headerSize = 0;
+  if (gzip) {
+    // No file name or modification time, unknown OS
+    const uint8_t extraFlags = level == 9 ? 2 : (level == 0 || level == 1) ? 4 : 0;
+    const uint8_t gzipHeader[10] = {0x1F, 0x8B, Z_DEFLATED, 0, 0, 0, 0, 0, extraFlags, 0xFF};
+    std::memcpy(header, gzipHeader, sizeof(gzipHeader));
+    headerSize = sizeof(gzipHeader);
+  } else if (!raw) {
+    // 32 KiB window, and the compression level hint zlib itself would write
+    const int32_t effective = level == Z_DEFAULT_COMPRESSION ? 6 : level;
+    const uint32_t levelFlags = effective < 2 ? 0 : effective < 6 ? 1 : effective == 6 ? 2 : 3;
+    uint32_t cmf = (0x78 << 8) | (levelFlags << 6);
+    cmf += 31 - cmf % 31;
+    header[0] = uint8_t(cmf >> 8);
+    header[1] = uint8_t(cmf);
+    headerSize = 2;
+  }
+
+  uint64_t total = headerSize + (gzip ? 8 : raw ? 0 : 4);
+  for (const Block& block : blocks) {
+    if (!block.ok)
+      return Z_STREAM_ERROR;
+    total += block.size;
+  }
+  if (total > dstLen)
+    return Z_BUF_ERROR;
+
+  std::memcpy(dst, header, headerSize);
+  uint8_t* out = dst + headerSize;
+  uLong check = gzip ? crc32(0, Z_NULL, 0) : adler32(0, Z_NULL, 0);
+  for (uint32_t i = 0; i < blockCount; ++i) {
+    const uint32_t length = (i + 1 == blockCount ? srcLen : (i + 1) * ParallelChunkSize) - i * ParallelChunkSize;
+    check = gzip ? crc32_combine(check, blocks[i].check, length) : adler32_combine(check, blocks[i].check, length);
+    std::memcpy(out, blocks[i].data.get(), blocks[i].size);
+    out += blocks[i].size;
+  }
+
+  if (gzip) {
+    // CRC-32 and input size, little endian
+    uint32_t trailer[2] = {uint32_t(check), srcLen};
+    utility::LittleUint32(trailer[0]);
+    utility::LittleUint32(trailer[1]);
+    std::memcpy(out, trailer, sizeof(trailer));
+    out += sizeof(trailer);
+  } else if (!raw) {
+    // Adler-32, big endian
+    uint32_t adler = uint32_t(check);
+    utility::BigUint32(adler);
+    std::memcpy(out, &adler, sizeof(adler));
+    out += sizeof(adler);
+  }
+  return int32_t(out - dst);
 }
 
 } // namespace athena::io::Compression
@@ -1,5 +1,17 @@
 #include "athena/FileReader.hpp"
 
+#include <algorithm>
+#include <cerrno>
+
+#if !GEKKO && !NX
+#include <climits>
+#include <cstddef>
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
 #if __APPLE__ || __FreeBSD__
 #include "osx_largefilewrapper.h"
 #elif GEKKO
@@ -9,14 +21,14 @@
 
 namespace athena::io {
 FileReader::FileReader(std::string_view filename, int32_t cacheSize, bool globalErr)
-: m_fileHandle(nullptr), m_cacheData(nullptr), m_offset(0), m_globalErr(globalErr) {
+: m_fileHandle(nullptr), m_offset(0), m_globalErr(globalErr) {
   m_filename = filename;
   open();
   setCacheSize(cacheSize);
 }
 
 FileReader::FileReader(std::wstring_view filename, int32_t cacheSize, bool globalErr)
-: m_fileHandle(nullptr), m_cacheData(nullptr), m_offset(0), m_globalErr(globalErr) {
+: m_fileHandle(nullptr), m_offset(0), m_globalErr(globalErr) {
   m_filename = utility::wideToUtf8(filename);
   open();
   setCacheSize(cacheSize);
@@ -54,6 +66,7 @@ void FileReader::close() {
 
   fclose(m_fileHandle);
   m_fileHandle = NULL;
+  clearGetArea();
   return;
 }
 
@@ -61,33 +74,9 @@ void FileReader::seek(int64_t pos, SeekOrigin origin) {
   if (!isOpen())
     return;
 
-  // check block position
-  if (m_blockSize > 0) {
-    switch (origin) {
-    case SeekOrigin::Begin:
-      m_offset = pos;
-      break;
-    case SeekOrigin::Current:
-      m_offset += pos;
-      break;
-    case SeekOrigin::End:
-      m_offset = length() - pos;
-      break;
-    }
-    if (m_offset > length()) {
-      if (m_globalErr)
-        atError("Unable to seek in file");
-      setError();
-      return;
-    }
-
-    size_t block = m_offset / m_blockSize;
-    if (int32_t(block) != m_curBlock) {
-      fseeko64(m_fileHandle, block * m_blockSize, SEEK_SET);
-      fread(m_cacheData.get(), 1, m_blockSize, m_fileHandle);
-      m_curBlock = int32_t(block);
-    }
-  } else if (fseeko64(m_fileHandle, pos, int(origin)) != 0) {
+  if (m_blockSize > 0)
+    seekCached(pos, origin);
+  else if (fseeko64(m_fileHandle, pos, int(origin)) != 0) {
     if (m_globalErr)
       atError("Unable to seek in file");
     setError();
@@ -102,7 +91,7 @@ uint64_t FileReader::position() const {
   }
 
   if (m_blockSize > 0)
-    return m_offset;
+    return m_getBegin ? m_getOffset + uint64_t(m_getCur - m_getBegin) : m_offset;
   else
     return uint64_t(ftello64(m_fileHandle));
 }
@@ -127,50 +116,90 @@ uint64_t FileReader::readUBytesToBuf(void* buf, uint64_t len) {
 
   if (m_blockSize <= 0)
     return fread(buf, 1, len, m_fileHandle);
-  else {
-    if (m_offset >= m_fileSize)
-      return 0;
-    if (m_offset + len >= m_fileSize)
-      len = m_fileSize - m_offset;
-
-    size_t block = m_offset / m_blockSize;
-    uint64_t cacheOffset = m_offset % m_blockSize;
-    uint64_t cacheSize;
-    uint64_t rem = len;
-    uint8_t* dst = (uint8_t*)buf;
-
-    while (rem) {
-      if (int32_t(block) != m_curBlock) {
-        fseeko64(m_fileHandle, block * m_blockSize, SEEK_SET);
-        fread(m_cacheData.get(), 1, m_blockSize, m_fileHandle);
-        m_curBlock = int32_t(block);
-      }
-
-      cacheSize = rem;
-      if (int32_t(cacheSize + cacheOffset) > m_blockSize)
-        cacheSize = m_blockSize - cacheOffset;
-
-      memmove(dst, m_cacheData.get() + cacheOffset, cacheSize);
-      dst += cacheSize;
-      rem -= cacheSize;
-      cacheOffset = 0;
-      ++block;
-    }
-    m_offset += len;
-    return uint64_t(dst - reinterpret_cast<uint8_t*>(buf));
+  return readCached(buf, len);
+}
+
+uint64_t FileReader::readFileAt(uint64_t offset, void* buf, uint64_t len) const {
+  uint8_t* dst = static_cast<uint8_t*>(buf);
+  uint64_t done = 0;
+#if GEKKO || NX
+  // No pread here. With the cache enabled nothing else uses the FILE position, without it the position is the
+  // stream position and has to be put back.
+  const int64_t saved = m_blockSize <= 0 ? ftello64(m_fileHandle) : -1;
+  if (fseeko64(m_fileHandle, offset, SEEK_SET) == 0)
+    done = fread(dst, 1, len, m_fileHandle);
+  if (saved >= 0)
+    fseeko64(m_fileHandle, saved, SEEK_SET);
+#else
+  const int fd = fileno(m_fileHandle);
+  while (done < len) {
+    const ssize_t ret = pread(fd, dst + done, size_t(len - done), off_t(offset + done));
+    if (ret < 0 && errno == EINTR)
+      continue;
+    if (ret <= 0)
+      break;
+    done += uint64_t(ret);
   }
+#endif
+  return done;
 }
 
-void FileReader::setCacheSize(const int32_t blockSize) {
-  m_blockSize = blockSize;
+uint64_t FileReader::readFileAt(uint64_t offset, std::span<const ScatterBuffer> bufs) const {
+#if GEKKO || NX || __APPLE__
+  // No preadv (Apple only has it from macOS 11), fill the segments one by one
+  uint64_t done = 0;
+  for (const ScatterBuffer& buf : bufs) {
+    const uint64_t read = readFileAt(offset + done, buf.data, buf.len);
+    done += read;
+    if (read != buf.len)
+      break;
+  }
+  return done;
+#else
+  static_assert(sizeof(ScatterBuffer) == sizeof(iovec) && offsetof(ScatterBuffer, len) == offsetof(iovec, iov_len),
+                "ScatterBuffer must match the layout of iovec");
+  const int fd = fileno(m_fileHandle);
+  uint64_t done = 0;
+  while (!bufs.empty()) {
+    const int count = int(std::min<size_t>(bufs.size(), IOV_MAX));
+    const ssize_t ret = preadv(fd, reinterpret_cast<const iovec*>(bufs.data()), count, off_t(offset + done));
+    if (ret < 0 && errno == EINTR)
+      continue;
+    if (ret <= 0)
+      break;
+    done += uint64_t(ret);
 
-  int32_t len = int32_t(length());
-  if (m_blockSize > len)
-    m_blockSize = len;
+    // Skip the segments that were filled completely, finish a partial one with pread
+    uint64_t rem = uint64_t(ret);
+    while (!bufs.empty() && rem >= bufs.front().len) {
+      rem -= bufs.front().len;
+      bufs = bufs.subspan(1);
+    }
+    if (rem && !bufs.empty()) {
+      const uint64_t tail = bufs.front().len - rem;
+      const uint64_t read = readFileAt(offset + done, static_cast<uint8_t*>(bufs.front().data) + rem, tail);
+      done += read;
+      if (read != tail)
+        break;
+      bufs = bufs.subspan(1);
+    }
+  }
+  return done;
+#endif
+}
 
-  m_curBlock = -1;
-  if (m_blockSize > 0)
-    m_cacheData.reset(new uint8_t[m_blockSize]);
+void FileReader::prefetchFileAt(uint64_t offset, uint64_t len) const {
+#if __APPLE__
+  struct radvisory ra;
+  ra.ra_offset = off_t(offset);
+  ra.ra_count = int(std::min<uint64_t>(len, INT32_MAX));
+  fcntl(fileno(m_fileHandle), F_RDADVISE, &ra);
+#elif !GEKKO && !NX
+  posix_fadvise(fileno(m_fileHandle), off_t(offset), off_t(len), POSIX_FADV_WILLNEED);
+#else
+  (void)offset;
+  (void)len;
+#endif
 }
 
 } // namespace athena::io
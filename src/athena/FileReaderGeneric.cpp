@@ -0,0 +1,214 @@
+#include "athena/FileReader.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace athena::io {
+void FileReader::setCacheSize(const int32_t blockSize) {
+  syncOffset();
+  m_blockSize = blockSize;
+
+  if (m_blockSize > 0 && uint64_t(m_blockSize) > m_fileSize)
+    m_blockSize = int32_t(m_fileSize);
+
+  resetCache();
+}
+
+void FileReader::setCacheBlockCount(uint32_t blockCount) {
+  syncOffset();
+  m_blockCount = std::max(blockCount, 1u);
+  resetCache();
+}
+
+uint64_t FileReader::readScatter(std::span<const ScatterBuffer> bufs) {
+  if (!isOpen()) {
+    if (m_globalErr)
+      atError("File not open for reading");
+    setError();
+    return 0;
+  }
+
+  uint64_t total = 0;
+  for (const ScatterBuffer& buf : bufs)
+    total += buf.len;
+
+  // Small batches are cheaper to serve from the block cache than with a syscall
+  if (m_blockSize > 0 && total < uint64_t(m_blockSize))
+    return IStreamReader::readScatter(bufs);
+
+  const uint64_t offset = position();
+  const uint64_t read = readFileAt(offset, bufs);
+  if (m_blockSize > 0) {
+    clearGetArea();
+    m_offset = offset + read;
+  } else {
+    seek(int64_t(offset + read), SeekOrigin::Begin);
+  }
+  return read;
+}
+
+uint64_t FileReader::readAt(uint64_t offset, void* buf, uint64_t len) const {
+  if (!isOpen()) {
+    if (m_globalErr)
+      atError("File not open for reading");
+    return 0;
+  }
+
+  if (offset >= m_fileSize)
+    return 0;
+  return readFileAt(offset, buf, std::min(len, m_fileSize - offset));
+}
+
+void FileReader::setReadahead(uint32_t maxBlocks) {
+  m_readaheadMax = maxBlocks;
+  m_readaheadWindow = 0;
+  m_readaheadEnd = 0;
+}
+
+void FileReader::trackReadahead(uint64_t first, uint64_t last) {
+  if (m_readaheadMax == 0)
+    return;
+
+  if (m_lastBlock != UINT64_MAX && first == m_lastBlock + 1) {
+    m_readaheadWindow = std::min(m_readaheadWindow ? m_readaheadWindow * 2 : 1u, m_readaheadMax);
+  } else {
+    m_readaheadWindow = 0;
+    m_readaheadEnd = 0;
+  }
+  m_lastBlock = last;
+
+  if (m_readaheadWindow == 0)
+    return;
+
+  // Only hint blocks that have not been hinted already and that lie inside the file
+  const uint64_t blockCount = (m_fileSize + m_blockSize - 1) / m_blockSize;
+  const uint64_t start = std::max(last + 1, m_readaheadEnd);
+  const uint64_t end = std::min(last + 1 + m_readaheadWindow, blockCount);
+  if (start >= end)
+    return;
+
+  prefetchFileAt(start * m_blockSize, (end - start) * m_blockSize);
+  m_readaheadEnd = end;
+}
+
+void FileReader::resetCache() {
+  clearGetArea();
+  m_cache.clear();
+  m_useCounter = 0;
+  if (m_blockSize > 0)
+    m_cache.resize(m_blockCount);
+}
+
+FileReader::CacheBlock* FileReader::loadBlock(uint64_t index) {
+  CacheBlock* victim = &m_cache.front();
+  for (CacheBlock& block : m_cache) {
+    if (block.index == index) {
+      block.lastUse = ++m_useCounter;
+      return &block;
+    }
+    if (block.lastUse < victim->lastUse)
+      victim = &block;
+  }
+
+  if (!victim->data)
+    victim->data.reset(new uint8_t[m_blockSize]);
+
+  trackReadahead(index, index);
+  const uint64_t read = readFileAt(index * m_blockSize, victim->data.get(), uint64_t(m_blockSize));
+  if (read == 0) {
+    victim->index = UINT64_MAX;
+    victim->lastUse = 0;
+    return nullptr;
+  }
+
+  victim->index = index;
+  victim->length = uint32_t(read);
+  victim->lastUse = ++m_useCounter;
+  return victim;
+}
+
+void FileReader::updateGetArea(const CacheBlock* block) {
+  const uint64_t blockStart = block ? block->index * m_blockSize : 0;
+  if (!block || m_offset < blockStart || m_offset > blockStart + block->length) {
+    clearGetArea();
+    return;
+  }
+  m_getOffset = blockStart;
+  setGetArea(block->data.get(), block->data.get() + (m_offset - blockStart), block->data.get() + block->length);
+}
+
+void FileReader::seekCached(int64_t pos, SeekOrigin origin) {
+  syncOffset();
+  switch (origin) {
+  case SeekOrigin::Begin:
+    m_offset = pos;
+    break;
+  case SeekOrigin::Current:
+    m_offset += pos;
+    break;
+  case SeekOrigin::End:
+    m_offset = m_fileSize - pos;
+    break;
+  }
+  if (m_offset > m_fileSize) {
+    if (m_globalErr)
+      atError("Unable to seek in file");
+    clearGetArea();
+    setError();
+    return;
+  }
+
+  // Only the position moves here, the block is loaded by the next read that needs it
+  const CacheBlock* found = nullptr;
+  for (const CacheBlock& block : m_cache) {
+    if (block.index == m_offset / m_blockSize) {
+      found = &block;
+      break;
+    }
+  }
+  updateGetArea(found);
+}
+
+uint64_t FileReader::readCached(void* buf, uint64_t len) {
+  syncOffset();
+  if (m_offset >= m_fileSize)
+    return 0;
+  if (m_offset + len >= m_fileSize)
+    len = m_fileSize - m_offset;
+
+  uint8_t* dst = static_cast<uint8_t*>(buf);
+  uint64_t rem = len;
+  const CacheBlock* last = nullptr;
+  while (rem) {
+    const uint64_t cacheOffset = m_offset % m_blockSize;
+
+    // Whole blocks go straight into the caller's buffer instead of evicting the cache
+    if (cacheOffset == 0 && rem >= uint64_t(m_blockSize)) {
+      const uint64_t direct = rem - rem % m_blockSize;
+      trackReadahead(m_offset / m_blockSize, (m_offset + direct) / m_blockSize - 1);
+      const uint64_t read = readFileAt(m_offset, dst, direct);
+      dst += read;
+      rem -= read;
+      m_offset += read;
+      last = nullptr;
+      if (read != direct)
+        break;
+      continue;
+    }
+
+    const CacheBlock* block = loadBlock(m_offset / m_blockSize);
+    if (!block || block->length <= cacheOffset)
+      break;
+
+    const uint64_t cacheSize = std::min(rem, block->length - cacheOffset);
+    std::memcpy(dst, block->data.get() + cacheOffset, cacheSize);
+    dst += cacheSize;
+    rem -= cacheSize;
+    m_offset += cacheSize;
+    last = block;
+  }
+
+  updateGetArea(last);
+  return uint64_t(dst - static_cast<uint8_t*>(buf));
+}
+} // namespace athena::io
@@ -1,5 +1,7 @@
 #include "athena/FileReader.hpp"
 
+#include <algorithm>
+
 #ifndef WIN32_LEAN_AND_MEAN
 #define WIN32_LEAN_AND_MEAN
 #endif
@@ -9,14 +11,14 @@
 
 namespace athena::io {
 FileReader::FileReader(std::string_view filename, int32_t cacheSize, bool globalErr)
-: m_fileHandle(nullptr), m_cacheData(nullptr), m_offset(0), m_globalErr(globalErr) {
+: m_fileHandle(nullptr), m_offset(0), m_globalErr(globalErr) {
   m_filename = utility::utf8ToWide(filename);
   open();
   setCacheSize(cacheSize);
 }
 
 FileReader::FileReader(std::wstring_view filename, int32_t cacheSize, bool globalErr)
-: m_fileHandle(nullptr), m_cacheData(nullptr), m_offset(0), m_globalErr(globalErr) {
+: m_fileHandle(nullptr), m_offset(0), m_globalErr(globalErr) {
   m_filename = filename;
   open();
   setCacheSize(cacheSize);
@@ -47,6 +49,10 @@ void FileReader::open() {
     return;
   }
 
+  LARGE_INTEGER size;
+  GetFileSizeEx(m_fileHandle, &size);
+  m_fileSize = uint64_t(size.QuadPart);
+
   // reset error
   m_hasError = false;
 }
@@ -61,6 +67,7 @@ void FileReader::close() {
 
   CloseHandle(m_fileHandle);
   m_fileHandle = 0;
+  clearGetArea();
   return;
 }
 
@@ -68,38 +75,9 @@ void FileReader::seek(int64_t pos, SeekOrigin origin) {
   if (!isOpen())
     return;
 
-  // check block position
-  if (m_blockSize > 0) {
-    uint64_t oldOff = m_offset;
-    switch (origin) {
-    case SeekOrigin::Begin:
-      m_offset = pos;
-      break;
-    case SeekOrigin::Current:
-      m_offset += pos;
-      break;
-    case SeekOrigin::End:
-      m_offset = length() - pos;
-      break;
-    }
-    if (m_offset > length()) {
-      oldOff = m_offset;
-      if (m_globalErr)
-        atError("Unable to seek in file");
-      setError();
-      return;
-    }
-
-    size_t block = m_offset / m_blockSize;
-    if (block != m_curBlock) {
-      LARGE_INTEGER li;
-      li.QuadPart = block * m_blockSize;
-      SetFilePointerEx(m_fileHandle, li, nullptr, FILE_BEGIN);
-      DWORD readSz;
-      ReadFile(m_fileHandle, m_cacheData.get(), m_blockSize, &readSz, nullptr);
-      m_curBlock = (int32_t)block;
-    }
-  } else {
+  if (m_blockSize > 0)
+    seekCached(pos, origin);
+  else {
     LARGE_INTEGER li;
     li.QuadPart = pos;
     if (!SetFilePointerEx(m_fileHandle, li, nullptr, DWORD(origin))) {
@@ -118,7 +96,7 @@ uint64_t FileReader::position() const {
   }
 
   if (m_blockSize > 0)
-    return m_offset;
+    return m_getBegin ? m_getOffset + uint64_t(m_getCur - m_getBegin) : m_offset;
   else {
     LARGE_INTEGER li = {};
     LARGE_INTEGER res;
@@ -151,54 +129,55 @@ uint64_t FileReader::readUBytesToBuf(void* buf, uint64_t len) {
     DWORD ret = 0;
     ReadFile(m_fileHandle, buf, len, &ret, nullptr);
     return ret;
-  } else {
-    LARGE_INTEGER fs;
-    GetFileSizeEx(m_fileHandle, &fs);
-    if (m_offset >= uint64_t(fs.QuadPart))
-      return 0;
-    if (m_offset + len >= uint64_t(fs.QuadPart))
-      len = fs.QuadPart - m_offset;
-
-    size_t block = m_offset / m_blockSize;
-    uint64_t cacheOffset = m_offset % m_blockSize;
-    uint64_t cacheSize;
-    uint64_t rem = len;
-    uint8_t* dst = (uint8_t*)buf;
-
-    while (rem) {
-      if (block != m_curBlock) {
-        LARGE_INTEGER li;
-        li.QuadPart = block * m_blockSize;
-        SetFilePointerEx(m_fileHandle, li, nullptr, FILE_BEGIN);
-        DWORD readSz;
-        ReadFile(m_fileHandle, m_cacheData.get(), m_blockSize, &readSz, nullptr);
-        m_curBlock = (int32_t)block;
-      }
-
-      cacheSize = rem;
-      if (cacheSize + cacheOffset > m_blockSize)
-        cacheSize = m_blockSize - cacheOffset;
-
-      memmove(dst, m_cacheData.get() + cacheOffset, cacheSize);
-      dst += cacheSize;
-      rem -= cacheSize;
-      cacheOffset = 0;
-      ++block;
-    }
-    m_offset += len;
-    return dst - (uint8_t*)buf;
   }
+  return readCached(buf, len);
 }
 
-void FileReader::setCacheSize(const int32_t blockSize) {
-  m_blockSize = blockSize;
+uint64_t FileReader::readFileAt(uint64_t offset, void* buf, uint64_t len) const {
+  // ReadFile moves the file pointer of a synchronous handle even with an OVERLAPPED offset. Without the cache
+  // that pointer is the stream position, so put it back afterwards.
+  const bool keepPointer = m_blockSize <= 0;
+  LARGE_INTEGER saved = {};
+  if (keepPointer) {
+    LARGE_INTEGER zero = {};
+    SetFilePointerEx(m_fileHandle, zero, &saved, FILE_CURRENT);
+  }
 
-  if (m_blockSize > length())
-    m_blockSize = (int32_t)length();
+  uint8_t* dst = static_cast<uint8_t*>(buf);
+  uint64_t done = 0;
+  while (done < len) {
+    OVERLAPPED ov = {};
+    ov.Offset = DWORD(offset + done);
+    ov.OffsetHigh = DWORD((offset + done) >> 32);
+    const DWORD chunk = DWORD(std::min<uint64_t>(len - done, 0x80000000));
+    DWORD ret = 0;
+    if (!ReadFile(m_fileHandle, dst + done, chunk, &ret, &ov) || ret == 0)
+      break;
+    done += ret;
+  }
 
-  m_curBlock = -1;
-  if (m_blockSize > 0)
-    m_cacheData.reset(new uint8_t[m_blockSize]);
+  if (keepPointer)
+    SetFilePointerEx(m_fileHandle, saved, nullptr, FILE_BEGIN);
+  return done;
+}
+
+uint64_t FileReader::readFileAt(uint64_t offset, std::span<const ScatterBuffer> bufs) const {
+  // ReadFileScatter needs unbuffered, page-aligned I/O, which the cache does not use
+  uint64_t done = 0;
+  for (const ScatterBuffer& buf : bufs) {
+    const uint64_t read = readFileAt(offset + done, buf.data, buf.len);
+    done += read;
+    if (read != buf.len)
+      break;
+  }
+  return done;
+}
+
+void FileReader::prefetchFileAt(uint64_t offset, uint64_t len) const {
+  // There is no readahead hint for plain file handles, the cache manager's own
+  // sequential detection has to do.
+  (void)offset;
+  (void)len;
 }
 
 } // namespace athena::io
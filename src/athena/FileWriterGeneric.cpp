@@ -1,8 +1,137 @@
 #include "athena/FileWriter.hpp"
 
+#include <algorithm>
 #include <cstring>
 
 namespace athena::io {
+void FileWriter::seek(int64_t pos, SeekOrigin origin) {
+  if (!isOpen()) {
+    if (m_globalErr)
+      atError("Unable to seek in file, not open");
+    setError();
+    return;
+  }
+
+  int64_t target = pos;
+  switch (origin) {
+  case SeekOrigin::Begin:
+    break;
+  case SeekOrigin::Current:
+    target += int64_t(m_position);
+    break;
+  case SeekOrigin::End:
+    target += int64_t(m_length);
+    break;
+  }
+  if (target < 0) {
+    if (m_globalErr)
+      atError("Unable to seek in file");
+    setError();
+    return;
+  }
+
+  // The OS position is only moved once something is written there
+  flush();
+  m_position = uint64_t(target);
+}
+
+void FileWriter::flush() {
+  if (!m_bufferLen)
+    return;
+
+  const uint64_t start = m_position - m_bufferLen;
+  const size_t len = m_bufferLen;
+  m_bufferLen = 0;
+  if ((m_filePos != start && !seekRaw(start)) || !writeRaw(m_buffer.get(), len)) {
+    if (m_globalErr)
+      atError("Unable to write to stream");
+    setError();
+    m_filePos = UINT64_MAX;
+    return;
+  }
+  m_filePos = start + len;
+}
+
+void FileWriter::setBufferSize(size_t size) {
+  flush();
+  m_bufferSize = size;
+  m_buffer.reset();
+}
+
+bool FileWriter::syncFilePos() {
+  if (m_filePos == m_position)
+    return true;
+  if (!seekRaw(m_position)) {
+    m_filePos = UINT64_MAX;
+    return false;
+  }
+  m_filePos = m_position;
+  return true;
+}
+
+void FileWriter::writeUBytes(const uint8_t* data, uint64_t len) {
+  if (!isOpen()) {
+    if (m_globalErr)
+      atError("File not open for writing");
+    setError();
+    return;
+  }
+
+  if (len < m_bufferSize) {
+    if (m_bufferLen + len > m_bufferSize)
+      flush();
+    if (!m_buffer)
+      m_buffer.reset(new uint8_t[m_bufferSize]);
+    std::memcpy(m_buffer.get() + m_bufferLen, data, len);
+    m_bufferLen += len;
+  } else {
+    // Too large to be worth combining, write it straight through
+    flush();
+    if (!syncFilePos() || !writeRaw(data, len)) {
+      if (m_globalErr)
+        atError("Unable to write to stream");
+      setError();
+      m_filePos = UINT64_MAX;
+      return;
+    }
+    m_filePos += len;
+  }
+
+  m_position += len;
+  m_length = std::max(m_length, m_position);
+}
+
+void FileWriter::writeGather(std::span<const GatherBuffer> bufs) {
+  if (!isOpen()) {
+    if (m_globalErr)
+      atError("File not open for writing");
+    setError();
+    return;
+  }
+
+  uint64_t total = 0;
+  for (const GatherBuffer& buf : bufs)
+    total += buf.len;
+
+  // Batches that fit are combined with the surrounding writes in the buffer
+  if (m_bufferLen + total <= m_bufferSize) {
+    IStreamWriter::writeGather(bufs);
+    return;
+  }
+
+  flush();
+  if (!syncFilePos() || !writeRawGather(bufs)) {
+    if (m_globalErr)
+      atError("Unable to write to stream");
+    setError();
+    m_filePos = UINT64_MAX;
+    return;
+  }
+  m_position += total;
+  m_filePos = m_position;
+  m_length = std::max(m_length, m_position);
+}
+
 void TransactionalFileWriter::seek(int64_t pos, SeekOrigin origin) {
   switch (origin) {
   case SeekOrigin::Begin:
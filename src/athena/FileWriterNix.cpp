@@ -7,6 +7,11 @@
 #include "osx_largefilewrapper.h"
 #endif
 
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+
+#include <sys/uio.h>
 #include <unistd.h>
 
 namespace athena::io {
@@ -55,6 +60,13 @@ void FileWriter::open(bool overwrite) {
     return;
   }
 
+  // Writes are combined in m_buffer, a second layer of stdio buffering would only add copies
+  setvbuf(m_fileHandle, nullptr, _IONBF, 0);
+  m_bufferLen = 0;
+  m_position = 0;
+  m_filePos = 0;
+  m_length = overwrite ? 0 : utility::fileSize(m_filename);
+
   // reset error
   m_hasError = false;
 }
@@ -67,6 +79,7 @@ void FileWriter::close() {
     return;
   }
 
+  flush();
   fclose(m_fileHandle);
   m_fileHandle = nullptr;
 
@@ -79,37 +92,56 @@ void FileWriter::close() {
   rename(tmpFilename.c_str(), m_filename.c_str());
 }
 
-void FileWriter::seek(int64_t pos, SeekOrigin origin) {
-  if (!isOpen()) {
-    if (m_globalErr)
-      atError("Unable to seek in file, not open");
-    setError();
-    return;
-  }
-
-  if (fseeko64(m_fileHandle, pos, int(origin)) != 0) {
-    if (m_globalErr)
-      atError("Unable to seek in file");
-    setError();
-  }
-}
-
-uint64_t FileWriter::position() const { return uint64_t(ftello64(m_fileHandle)); }
+bool FileWriter::writeRaw(const uint8_t* data, uint64_t len) { return fwrite(data, 1, len, m_fileHandle) == len; }
 
-uint64_t FileWriter::length() const { return utility::fileSize(m_filename); }
+bool FileWriter::seekRaw(uint64_t pos) { return fseeko64(m_fileHandle, pos, SEEK_SET) == 0; }
 
-void FileWriter::writeUBytes(const uint8_t* data, uint64_t len) {
-  if (!isOpen()) {
-    if (m_globalErr)
-      atError("File not open for writing");
-    setError();
-    return;
+bool FileWriter::writeRawGather(std::span<const GatherBuffer> bufs) {
+#if defined(GEKKO) || defined(__SWITCH__)
+  for (const GatherBuffer& buf : bufs) {
+    if (!writeRaw(static_cast<const uint8_t*>(buf.data), buf.len))
+      return false;
   }
+  return true;
+#else
+  static_assert(sizeof(GatherBuffer) == sizeof(iovec) && offsetof(GatherBuffer, len) == offsetof(iovec, iov_len),
+                "GatherBuffer must match the layout of iovec");
+
+  // The FILE is unbuffered, so the fd already sits at the stdio position
+  const int fd = fileno(m_fileHandle);
+  uint64_t written = 0;
+  std::vector<GatherBuffer> rest;
+  bool ok = true;
+  while (!bufs.empty()) {
+    const int count = int(std::min<size_t>(bufs.size(), IOV_MAX));
+    const ssize_t ret = writev(fd, reinterpret_cast<const iovec*>(bufs.data()), count);
+    if (ret < 0 && errno == EINTR)
+      continue;
+    if (ret <= 0) {
+      ok = false;
+      break;
+    }
+    written += uint64_t(ret);
 
-  if (fwrite(data, 1, len, m_fileHandle) != len) {
-    if (m_globalErr)
-      atError("Unable to write to stream");
-    setError();
+    // Drop the segments written completely, retry the remainder of a partial one
+    size_t rem = size_t(ret);
+    while (!bufs.empty() && rem >= bufs.front().len) {
+      rem -= bufs.front().len;
+      bufs = bufs.subspan(1);
+    }
+    if (rem) {
+      std::vector<GatherBuffer> remaining(bufs.begin(), bufs.end());
+      remaining.front().data = static_cast<const uint8_t*>(remaining.front().data) + rem;
+      remaining.front().len -= rem;
+      rest.swap(remaining);
+      bufs = rest;
+    }
   }
+
+  // stdio may cache the file offset, move it past what was written behind its back
+  if (ok)
+    ok = fseeko64(m_fileHandle, m_position + written, SEEK_SET) == 0;
+  return ok;
+#endif
 }
 } // namespace athena::io
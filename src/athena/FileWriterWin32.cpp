@@ -56,6 +56,16 @@ void FileWriter::open(bool overwrite) {
     return;
   }
 
+  m_bufferLen = 0;
+  m_position = 0;
+  m_filePos = 0;
+  m_length = 0;
+  if (!overwrite) {
+    LARGE_INTEGER size;
+    GetFileSizeEx(m_fileHandle, &size);
+    m_length = uint64_t(size.QuadPart);
+  }
+
   // reset error
   m_hasError = false;
 }
@@ -68,6 +78,7 @@ void FileWriter::close() {
     return;
   }
 
+  flush();
   FlushFileBuffers(m_fileHandle);
   CloseHandle(m_fileHandle);
   m_fileHandle = 0;
@@ -76,57 +87,31 @@ void FileWriter::close() {
   MoveFileExW(tmpFilename.c_str(), m_filename.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
 }
 
-void FileWriter::seek(int64_t pos, SeekOrigin origin) {
-  if (!isOpen()) {
-    if (m_globalErr)
-      atError("Unable to seek in file, not open");
-    setError();
-    return;
-  }
-
-  LARGE_INTEGER li;
-  li.QuadPart = pos;
-  if (!SetFilePointerEx(m_fileHandle, li, nullptr, DWORD(origin))) {
-    if (m_globalErr)
-      atError("Unable to seek in file");
-    setError();
-  }
-}
-
-uint64_t FileWriter::position() const {
-  LARGE_INTEGER li = {};
-  LARGE_INTEGER res;
-  SetFilePointerEx(m_fileHandle, li, &res, FILE_CURRENT);
-  return static_cast<uint64_t>(res.QuadPart);
-}
-
-uint64_t FileWriter::length() const { return utility::fileSize(m_filename); }
-
-void FileWriter::writeUBytes(const uint8_t* data, uint64_t len) {
-  if (!isOpen()) {
-    if (m_globalErr) {
-      atError("File not open for writing");
-    }
-    setError();
-    return;
-  }
-
+bool FileWriter::writeRaw(const uint8_t* data, uint64_t len) {
   uint64_t remaining = len;
-  do {
+  while (remaining != 0) {
     const auto toWrite = static_cast<DWORD>(std::min(remaining, uint64_t{std::numeric_limits<DWORD>::max()}));
     DWORD written = 0;
-
-    if (WriteFile(m_fileHandle, data, toWrite, &written, nullptr) == FALSE) {
-      if (m_globalErr) {
-        atError("Unable to write to file");
-      }
-      setError();
-      return;
-    }
-
+    if (WriteFile(m_fileHandle, data, toWrite, &written, nullptr) == FALSE)
+      return false;
     remaining -= written;
     data += written;
-  } while (remaining != 0);
+  }
+  return true;
+}
+
+bool FileWriter::writeRawGather(std::span<const GatherBuffer> bufs) {
+  // WriteFileGather needs unbuffered, page-aligned I/O, which this writer does not use
+  for (const GatherBuffer& buf : bufs) {
+    if (!writeRaw(static_cast<const uint8_t*>(buf.data), buf.len))
+      return false;
+  }
+  return true;
 }
 
+bool FileWriter::seekRaw(uint64_t pos) {
+  LARGE_INTEGER li;
+  li.QuadPart = int64_t(pos);
+  return SetFilePointerEx(m_fileHandle, li, nullptr, FILE_BEGIN) != FALSE;
+}
 } // namespace athena::io
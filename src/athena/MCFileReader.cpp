@@ -11,7 +11,7 @@ MCFileReader::MCFileReader(const std::string& filename) : MemoryCopyReader(filen
 
 MCFile* MCFileReader::readFile() {
   bool isScrambled = readUint32() != SCRAMBLE_VALUE;
-  m_position = 0;
+  seek(0, SeekOrigin::Begin);
 
   if (isScrambled)
     MCFile::unscramble(m_dataCopy.get(), m_length);
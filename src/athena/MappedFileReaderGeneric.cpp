@@ -0,0 +1,92 @@
+#include "athena/MappedFileReader.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace athena::io {
+void MappedFileReader::seek(int64_t pos, SeekOrigin origin) {
+  if (!isOpen()) {
+    if (m_globalErr)
+      atError("Unable to seek in file, not open");
+    setError();
+    return;
+  }
+
+  const uint64_t curPos = position();
+  int64_t target = 0;
+  switch (origin) {
+  case SeekOrigin::Begin:
+    target = pos;
+    break;
+  case SeekOrigin::Current:
+    target = int64_t(curPos) + pos;
+    break;
+  case SeekOrigin::End:
+    target = int64_t(m_length) - pos;
+    break;
+  }
+
+  if (target < 0 || uint64_t(target) > m_length) {
+    if (m_globalErr)
+      atError("Unable to seek in file");
+    setError();
+    return;
+  }
+
+  m_getCur = m_getBegin + target;
+}
+
+uint64_t MappedFileReader::readUBytesToBuf(void* buf, uint64_t len) {
+  if (!isOpen()) {
+    if (m_globalErr)
+      atError("File not open for reading");
+    setError();
+    return 0;
+  }
+
+  const uint64_t curPos = position();
+  if (curPos >= m_length)
+    return 0;
+
+  len = std::min(len, m_length - curPos);
+  std::memcpy(buf, m_getCur, len);
+  m_getCur += len;
+  return len;
+}
+
+uint64_t MappedFileReader::readAt(uint64_t offset, void* buf, uint64_t len) const {
+  if (!isOpen()) {
+    if (m_globalErr)
+      atError("File not open for reading");
+    return 0;
+  }
+
+  if (offset >= m_length)
+    return 0;
+
+  len = std::min(len, m_length - offset);
+  std::memcpy(buf, m_data + offset, len);
+  return len;
+}
+
+std::span<const uint8_t> MappedFileReader::peekView(uint64_t len) {
+  const uint64_t curPos = position();
+  if (curPos >= m_length)
+    return {};
+
+  return {m_getCur, size_t(std::min(len, m_length - curPos))};
+}
+
+const uint8_t* MappedFileReader::borrowUBytes(uint64_t len) {
+  if (!isOpen() || len > m_length - position()) {
+    if (m_globalErr)
+      atError("Position {:08X} outside stream bounds ", position());
+    setError();
+    return nullptr;
+  }
+
+  const uint8_t* ret = m_getCur;
+  m_getCur += len;
+  return ret;
+}
+} // namespace athena::io
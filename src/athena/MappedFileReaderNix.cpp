@@ -0,0 +1,110 @@
+#include "athena/MappedFileReader.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace athena::io {
+MappedFileReader::MappedFileReader(std::string_view filename, Advice advice, bool globalErr)
+: m_advice(advice), m_globalErr(globalErr) {
+  m_filename = filename;
+  open();
+}
+
+MappedFileReader::MappedFileReader(std::wstring_view filename, Advice advice, bool globalErr)
+: m_advice(advice), m_globalErr(globalErr) {
+  m_filename = utility::wideToUtf8(filename);
+  open();
+}
+
+MappedFileReader::~MappedFileReader() {
+  if (isOpen())
+    close();
+}
+
+void MappedFileReader::open() {
+  m_fd = ::open(m_filename.c_str(), O_RDONLY);
+  if (m_fd < 0) {
+    if (m_globalErr)
+      atError("File not found '{}'", m_filename);
+    setError();
+    return;
+  }
+
+  struct stat st;
+  if (fstat(m_fd, &st) != 0) {
+    if (m_globalErr)
+      atError("Unable to stat '{}'", m_filename);
+    ::close(m_fd);
+    m_fd = -1;
+    setError();
+    return;
+  }
+
+  m_length = uint64_t(st.st_size);
+
+  // mmap refuses zero-length mappings, an empty file is still a valid (empty) stream
+  if (m_length > 0) {
+    void* addr = mmap(nullptr, size_t(m_length), PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (addr == MAP_FAILED) {
+      if (m_globalErr)
+        atError("Unable to map '{}'", m_filename);
+      ::close(m_fd);
+      m_fd = -1;
+      m_length = 0;
+      setError();
+      return;
+    }
+    m_data = static_cast<const uint8_t*>(addr);
+  }
+
+  m_isOpen = true;
+  setGetArea(m_data, m_data, m_data ? m_data + m_length : nullptr);
+  setAdvice(m_advice);
+
+  // reset error
+  m_hasError = false;
+}
+
+void MappedFileReader::close() {
+  if (!m_isOpen) {
+    if (m_globalErr)
+      atError("Cannot close an unopened stream");
+    setError();
+    return;
+  }
+
+  if (m_data)
+    munmap(const_cast<uint8_t*>(m_data), size_t(m_length));
+  ::close(m_fd);
+  m_fd = -1;
+  m_data = nullptr;
+  m_length = 0;
+  clearGetArea();
+  m_isOpen = false;
+}
+
+void MappedFileReader::setAdvice(Advice advice) {
+  m_advice = advice;
+  if (!m_data)
+    return;
+
+  int flag = MADV_NORMAL;
+  switch (advice) {
+  case Advice::Normal:
+    flag = MADV_NORMAL;
+    break;
+  case Advice::Sequential:
+    flag = MADV_SEQUENTIAL;
+    break;
+  case Advice::Random:
+    flag = MADV_RANDOM;
+    break;
+  case Advice::WillNeed:
+    flag = MADV_WILLNEED;
+    break;
+  }
+  madvise(const_cast<uint8_t*>(m_data), size_t(m_length), flag);
+}
+} // namespace athena::io
@@ -0,0 +1,108 @@
+#include "athena/MappedFileReader.hpp"
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+
+namespace athena::io {
+MappedFileReader::MappedFileReader(std::string_view filename, Advice advice, bool globalErr)
+: m_advice(advice), m_globalErr(globalErr) {
+  m_filename = utility::utf8ToWide(filename);
+  open();
+}
+
+MappedFileReader::MappedFileReader(std::wstring_view filename, Advice advice, bool globalErr)
+: m_advice(advice), m_globalErr(globalErr) {
+  m_filename = filename;
+  open();
+}
+
+MappedFileReader::~MappedFileReader() {
+  if (isOpen())
+    close();
+}
+
+void MappedFileReader::open() {
+  int attempt = 0;
+  HANDLE file;
+  do {
+#if WINDOWS_STORE
+    file = CreateFile2(m_filename.c_str(), GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, nullptr);
+#else
+    file = CreateFileW(m_filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                       FILE_ATTRIBUTE_NORMAL, nullptr);
+#endif
+  } while (file == INVALID_HANDLE_VALUE && attempt++ < 100);
+
+  if (file == INVALID_HANDLE_VALUE) {
+    std::string _filename = filename();
+    if (m_globalErr)
+      atError("File not found '{}'", _filename);
+    setError();
+    return;
+  }
+
+  LARGE_INTEGER size;
+  GetFileSizeEx(file, &size);
+  m_length = uint64_t(size.QuadPart);
+
+  // CreateFileMapping refuses zero-length mappings, an empty file is still a valid (empty) stream
+  if (m_length > 0) {
+#if WINDOWS_STORE
+    HANDLE mapping = CreateFileMappingFromApp(file, nullptr, PAGE_READONLY, 0, nullptr);
+    void* addr = mapping ? MapViewOfFileFromApp(mapping, FILE_MAP_READ, 0, 0) : nullptr;
+#else
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* addr = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+#endif
+    if (!addr) {
+      std::string _filename = filename();
+      if (m_globalErr)
+        atError("Unable to map '{}'", _filename);
+      if (mapping)
+        CloseHandle(mapping);
+      CloseHandle(file);
+      m_length = 0;
+      setError();
+      return;
+    }
+    m_mappingHandle = mapping;
+    m_data = static_cast<const uint8_t*>(addr);
+  }
+
+  m_fileHandle = file;
+  m_isOpen = true;
+  setGetArea(m_data, m_data, m_data ? m_data + m_length : nullptr);
+  setAdvice(m_advice);
+
+  // reset error
+  m_hasError = false;
+}
+
+void MappedFileReader::close() {
+  if (!m_isOpen) {
+    if (m_globalErr)
+      atError("Cannot close an unopened stream");
+    setError();
+    return;
+  }
+
+  if (m_data)
+    UnmapViewOfFile(m_data);
+  if (m_mappingHandle)
+    CloseHandle(m_mappingHandle);
+  CloseHandle(m_fileHandle);
+  m_fileHandle = nullptr;
+  m_mappingHandle = nullptr;
+  m_data = nullptr;
+  m_length = 0;
+  clearGetArea();
+  m_isOpen = false;
+}
+
+void MappedFileReader::setAdvice(Advice advice) {
+  // The memory manager has no per-view readahead policy to tune; the hint is only recorded.
+  m_advice = advice;
+}
+} // namespace athena::io
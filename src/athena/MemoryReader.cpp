@@ -10,13 +10,14 @@
 
 namespace athena::io {
 MemoryReader::MemoryReader(const void* data, uint64_t length, bool takeOwnership, bool globalErr)
-: m_data(data), m_length(length), m_position(0), m_owns(takeOwnership), m_globalErr(globalErr) {
+: m_data(data), m_length(length), m_owns(takeOwnership), m_globalErr(globalErr) {
   if (!data) {
     if (m_globalErr)
       atError("data cannot be NULL");
     setError();
     return;
   }
+  resetGetArea();
 }
 
 MemoryReader::~MemoryReader() {
@@ -35,44 +36,55 @@ MemoryCopyReader::MemoryCopyReader(const void* data, uint64_t length) : MemoryRe
   m_dataCopy.reset(new uint8_t[m_length]);
   m_data = m_dataCopy.get();
   memmove(m_dataCopy.get(), data, m_length);
+  resetGetArea();
+}
+
+void MemoryReader::resetGetArea(uint64_t position) {
+  if (!m_data) {
+    clearGetArea();
+    return;
+  }
+  const auto* begin = static_cast<const uint8_t*>(m_data);
+  setGetArea(begin, begin + position, begin + m_length);
 }
 
 void MemoryReader::seek(int64_t position, SeekOrigin origin) {
+  const uint64_t curPos = MemoryReader::position();
   switch (origin) {
   case SeekOrigin::Begin:
     if ((position < 0 || int64_t(position) > int64_t(m_length))) {
       if (m_globalErr)
         atFatal("Position {:08X} outside stream bounds ", position);
-      m_position = m_length;
+      setPosition(m_length);
       setError();
       return;
     }
 
-    m_position = uint64_t(position);
+    setPosition(uint64_t(position));
     break;
 
   case SeekOrigin::Current:
-    if (((int64_t(m_position) + position) < 0 || (m_position + uint64_t(position)) > m_length)) {
+    if (((int64_t(curPos) + position) < 0 || (curPos + uint64_t(position)) > m_length)) {
       if (m_globalErr)
         atFatal("Position {:08X} outside stream bounds ", position);
-      m_position = (position < 0 ? 0 : m_length);
+      setPosition(position < 0 ? 0 : m_length);
       setError();
       return;
     }
 
-    m_position += position;
+    setPosition(curPos + position);
     break;
 
   case SeekOrigin::End:
     if ((((int64_t)m_length - position < 0) || (m_length - position) > m_length)) {
       if (m_globalErr)
         atFatal("Position {:08X} outside stream bounds ", position);
-      m_position = m_length;
+      setPosition(m_length);
       setError();
       return;
     }
 
-    m_position = m_length - position;
+    setPosition(m_length - position);
     break;
   }
 }
@@ -82,8 +94,8 @@ void MemoryReader::setData(const uint8_t* data, uint64_t length, bool takeOwners
     delete[] static_cast<const uint8_t*>(m_data);
   m_data = (uint8_t*)data;
   m_length = length;
-  m_position = 0;
   m_owns = takeOwnership;
+  resetGetArea();
 }
 
 void MemoryCopyReader::setData(const uint8_t* data, uint64_t length) {
@@ -91,7 +103,7 @@ void MemoryCopyReader::setData(const uint8_t* data, uint64_t length) {
   m_data = m_dataCopy.get();
   memmove(m_dataCopy.get(), data, length);
   m_length = length;
-  m_position = 0;
+  resetGetArea();
 }
 
 uint8_t* MemoryReader::data() const {
@@ -102,20 +114,63 @@ uint8_t* MemoryReader::data() const {
 }
 
 uint64_t MemoryReader::readUBytesToBuf(void* buf, uint64_t length) {
-  if (m_position >= m_length) {
+  const uint64_t curPos = position();
+  if (curPos >= m_length) {
+    if (m_globalErr)
+      atError("Position {:08X} outside stream bounds ", curPos);
+    setPosition(m_length);
+    setError();
+    return 0;
+  }
+
+  length = std::min(length, m_length - curPos);
+  memmove(buf, m_getCur, length);
+  m_getCur += length;
+  return length;
+}
+
+uint64_t MemoryReader::readScatter(std::span<const ScatterBuffer> bufs) {
+  const uint64_t curPos = position();
+  uint64_t total = 0;
+  for (const ScatterBuffer& buf : bufs)
+    total += buf.len;
+  if (total && curPos >= m_length) {
     if (m_globalErr)
-      atError("Position {:08X} outside stream bounds ", m_position);
-    m_position = m_length;
+      atError("Position {:08X} outside stream bounds ", curPos);
     setError();
     return 0;
   }
+  total = std::min(total, m_length - curPos);
+
+  uint64_t rem = total;
+  for (const ScatterBuffer& buf : bufs) {
+    const uint64_t len = std::min<uint64_t>(buf.len, rem);
+    memmove(buf.data, m_getCur, len);
+    m_getCur += len;
+    rem -= len;
+    if (!rem)
+      break;
+  }
+  return total;
+}
 
-  length = std::min(length, m_length - m_position);
-  memmove(buf, static_cast<const uint8_t*>(m_data) + m_position, length);
-  m_position += length;
+uint64_t MemoryReader::readAt(uint64_t offset, void* buf, uint64_t length) const {
+  if (!m_data || offset >= m_length)
+    return 0;
+
+  length = std::min(length, m_length - offset);
+  memmove(buf, static_cast<const uint8_t*>(m_data) + offset, length);
   return length;
 }
 
+std::span<const uint8_t> MemoryReader::peekView(uint64_t length) {
+  const uint64_t curPos = position();
+  if (curPos >= m_length)
+    return {};
+
+  return {m_getCur, size_t(std::min(length, m_length - curPos))};
+}
+
 void MemoryCopyReader::loadData() {
   FILE* in;
   uint64_t length;
@@ -157,7 +212,7 @@ void MemoryCopyReader::loadData() {
 
   fclose(in);
   m_length = length;
-  m_position = 0;
+  resetGetArea();
 }
 
 } // namespace athena::io
@@ -1,5 +1,6 @@
 #include "athena/MemoryWriter.hpp"
 
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 
@@ -20,7 +21,7 @@ MemoryWriter::MemoryWriter(uint8_t* data, uint64_t length, bool takeOwnership)
 
 MemoryWriter::~MemoryWriter() {
   if (m_bufferOwned)
-    delete m_data;
+    delete[] m_data;
   m_data = nullptr;
   m_length = 0;
 }
@@ -38,15 +39,19 @@ MemoryCopyWriter::MemoryCopyWriter(uint8_t* data, uint64_t length) {
   }
   m_dataCopy.reset(new uint8_t[length]);
   m_data = m_dataCopy.get();
+  m_capacity = length;
   if (data)
     memmove(m_data, data, length);
+  else
+    memset(m_data, 0, length);
 }
 
 MemoryCopyWriter::MemoryCopyWriter(std::string_view filename) {
   m_filepath = filename;
-  m_length = 0x10;
+  m_length = 0;
   m_position = 0;
-  m_dataCopy.reset(new uint8_t[m_length]);
+  m_capacity = 0x10;
+  m_dataCopy.reset(new uint8_t[m_capacity]);
   m_data = m_dataCopy.get();
   m_bufferOwned = false;
 
@@ -57,6 +62,21 @@ MemoryCopyWriter::MemoryCopyWriter(std::string_view filename) {
   }
 }
 
+MemoryCopyWriter::MemoryCopyWriter(std::unique_ptr<uint8_t[]> data, uint64_t length) {
+  m_position = 0;
+  m_bufferOwned = false;
+
+  if (!data) {
+    atError("data cannot be NULL");
+    setError();
+    return;
+  }
+  m_dataCopy = std::move(data);
+  m_data = m_dataCopy.get();
+  m_length = length;
+  m_capacity = length;
+}
+
 void MemoryWriter::seek(int64_t position, SeekOrigin origin) {
   switch (origin) {
   case SeekOrigin::Begin:
@@ -154,7 +174,7 @@ void MemoryCopyWriter::seek(int64_t position, SeekOrigin origin) {
 
 void MemoryWriter::setData(uint8_t* data, uint64_t length, bool takeOwnership) {
   if (m_bufferOwned)
-    delete m_data;
+    delete[] m_data;
 
   m_data = data;
   m_length = length;
@@ -167,6 +187,7 @@ void MemoryCopyWriter::setData(const uint8_t* data, uint64_t length) {
   m_data = m_dataCopy.get();
   memmove(m_data, data, length);
   m_length = length;
+  m_capacity = length;
   m_position = 0;
   m_bufferOwned = false;
 }
@@ -178,6 +199,23 @@ uint8_t* MemoryWriter::data() const {
   return ret;
 }
 
+uint8_t* MemoryWriter::release() {
+  uint8_t* ret = m_data;
+  m_data = nullptr;
+  m_length = 0;
+  m_position = 0;
+  m_bufferOwned = false;
+  return ret;
+}
+
+std::unique_ptr<uint8_t[]> MemoryCopyWriter::takeBuffer() {
+  m_data = nullptr;
+  m_length = 0;
+  m_capacity = 0;
+  m_position = 0;
+  return std::move(m_dataCopy);
+}
+
 void MemoryWriter::save(std::string_view filename) {
   if (filename.empty() && m_filepath.empty()) {
     atError("No file specified, cannot save.");
@@ -246,12 +284,42 @@ void MemoryCopyWriter::writeUBytes(const uint8_t* data, uint64_t length) {
     return;
   }
 
-  if (m_position + length > m_length)
-    resize(m_position + length);
+  if (m_position + length > m_capacity)
+    grow(m_position + length);
 
   memmove(m_data + m_position, data, length);
 
   m_position += length;
+  if (m_position > m_length)
+    m_length = m_position;
+}
+
+void MemoryCopyWriter::writeGather(std::span<const GatherBuffer> bufs) {
+  uint64_t total = 0;
+  for (const GatherBuffer& buf : bufs)
+    total += buf.len;
+
+  if (m_position + total > m_capacity)
+    grow(m_position + total);
+
+  for (const GatherBuffer& buf : bufs) {
+    if (!buf.len)
+      continue;
+    memmove(m_data + m_position, buf.data, buf.len);
+    m_position += buf.len;
+  }
+  if (m_position > m_length)
+    m_length = m_position;
+}
+
+void MemoryCopyWriter::reserve(uint64_t capacity) {
+  if (capacity > m_capacity)
+    reallocate(capacity);
+}
+
+void MemoryCopyWriter::shrinkToFit() {
+  if (m_length < m_capacity && m_length > 0)
+    reallocate(m_length);
 }
 
 void MemoryCopyWriter::resize(uint64_t newSize) {
@@ -260,16 +328,29 @@ void MemoryCopyWriter::resize(uint64_t newSize) {
     return;
   }
 
-  // Allocate and copy new buffer
-  auto newArray = std::make_unique<uint8_t[]>(newSize);
-  if (m_dataCopy) {
-    std::memmove(newArray.get(), m_dataCopy.get(), m_length);
-  }
+  if (newSize > m_capacity)
+    grow(newSize);
+
+  // Spare capacity past the old end is uninitialized
+  std::memset(m_data + m_length, 0, newSize - m_length);
+  m_length = newSize;
+}
+
+void MemoryCopyWriter::grow(uint64_t minCapacity) {
+  // Grow by half again each time so a long run of small appends is amortized O(1)
+  reallocate(std::max(minCapacity, m_capacity + m_capacity / 2));
+}
+
+void MemoryCopyWriter::reallocate(uint64_t capacity) {
+  // Allocate and copy new buffer, only the logical contents are worth keeping
+  std::unique_ptr<uint8_t[]> newArray(new uint8_t[capacity]);
+  if (m_data)
+    std::memcpy(newArray.get(), m_data, std::min(m_length, capacity));
   m_dataCopy = std::move(newArray);
 
-  // Swap the pointer and size out for the new ones.
+  // Swap the pointer and capacity out for the new ones.
   m_data = m_dataCopy.get();
-  m_length = newSize;
+  m_capacity = capacity;
 }
 
 } // namespace athena::io
@@ -43,12 +43,12 @@ SkywardSwordFile* SkywardSwordFileReader::read() {
                        : (magic == SkywardSwordFile::JAMagic ? Region::NTSCJ : Region::PAL)));
 
   for (int i = 0; i < 3; i++) {
+    // Quests own and edit their slot data, so that is still copied out
     SkywardSwordQuest* q = new SkywardSwordQuest(readUBytes(0x53C0), 0x53C0);
-    uint64_t pos = position();
-    // seek to the skip data for this particular quest
-    seek(0xFB60 + (i * 0x24), SeekOrigin::Begin);
-    q->setSkipData(readUBytes(0x24));
-    seek(pos, SeekOrigin::Begin);
+    // the skip data for this particular quest lives after all three slots
+    std::unique_ptr<uint8_t[]> skipData(new uint8_t[0x24]);
+    readAt(0xFB60 + (i * 0x24), skipData.get(), 0x24);
+    q->setSkipData(std::move(skipData));
     file->addQuest(q);
   }
 
@@ -0,0 +1,109 @@
+#include "athena/SubStreamReader.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace athena::io {
+SubStreamReader::SubStreamReader(std::span<const uint8_t> data, bool globalErr)
+: m_data(data.data()), m_length(data.size()), m_globalErr(globalErr) {
+  setGetArea(m_data, m_data, m_data + m_length);
+}
+
+SubStreamReader::SubStreamReader(std::shared_ptr<const uint8_t[]> data, uint64_t offset, uint64_t length,
+                                 bool globalErr)
+: m_owner(std::move(data)), m_offset(offset), m_length(length), m_globalErr(globalErr) {
+  if (!m_owner) {
+    if (m_globalErr)
+      atError("data cannot be NULL");
+    m_length = 0;
+    setError();
+    return;
+  }
+  m_data = m_owner.get() + offset;
+  setGetArea(m_data, m_data, m_data + m_length);
+}
+
+SubStreamReader::SubStreamReader(IStreamReader& parent, uint64_t offset, uint64_t length, bool globalErr)
+: m_parent(&parent), m_offset(offset), m_length(length), m_globalErr(globalErr) {
+  setEndian(parent.endian());
+  if (offset > parent.length() || length > parent.length() - offset) {
+    if (m_globalErr)
+      atError("Window {:08X}+{:08X} outside parent stream bounds", offset, length);
+    m_length = offset > parent.length() ? 0 : parent.length() - offset;
+    setError();
+  }
+}
+
+void SubStreamReader::setPosition(uint64_t pos) {
+  if (m_parent)
+    m_position = pos;
+  else
+    m_getCur = m_getBegin + pos;
+}
+
+void SubStreamReader::seek(int64_t pos, SeekOrigin origin) {
+  int64_t target = 0;
+  switch (origin) {
+  case SeekOrigin::Begin:
+    target = pos;
+    break;
+  case SeekOrigin::Current:
+    target = int64_t(position()) + pos;
+    break;
+  case SeekOrigin::End:
+    target = int64_t(m_length) - pos;
+    break;
+  }
+
+  if (target < 0 || uint64_t(target) > m_length) {
+    if (m_globalErr)
+      atError("Position {:08X} outside stream bounds ", target);
+    setPosition(target < 0 ? 0 : m_length);
+    setError();
+    return;
+  }
+
+  setPosition(uint64_t(target));
+}
+
+uint64_t SubStreamReader::readUBytesToBuf(void* buf, uint64_t len) {
+  const uint64_t curPos = position();
+  if (curPos >= m_length) {
+    if (m_globalErr)
+      atError("Position {:08X} outside stream bounds ", curPos);
+    setError();
+    return 0;
+  }
+
+  len = std::min(len, m_length - curPos);
+  if (!m_parent) {
+    std::memcpy(buf, m_getCur, len);
+    m_getCur += len;
+    return len;
+  }
+
+  const uint64_t parentPos = m_parent->position();
+  m_parent->seek(int64_t(m_offset + curPos), SeekOrigin::Begin);
+  const uint64_t read = m_parent->readUBytesToBuf(buf, len);
+  m_parent->seek(int64_t(parentPos), SeekOrigin::Begin);
+  m_position += read;
+  return read;
+}
+
+std::span<const uint8_t> SubStreamReader::peekView(uint64_t len) {
+  const uint64_t curPos = position();
+  if (curPos >= m_length)
+    return {};
+
+  len = std::min(len, m_length - curPos);
+  if (!m_parent)
+    return {m_getCur, size_t(len)};
+
+  // Only as long-lived as any other view of the parent, i.e. until it is next read
+  const uint64_t parentPos = m_parent->position();
+  m_parent->seek(int64_t(m_offset + curPos), SeekOrigin::Begin);
+  const std::span<const uint8_t> view = m_parent->peekView(len);
+  m_parent->seek(int64_t(parentPos), SeekOrigin::Begin);
+  return view;
+}
+} // namespace athena::io
@@ -18,6 +18,23 @@
 #include <locale>
 #endif
 
+#if (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)) && !defined(GEKKO)
+#define ATHENA_SWAP_X86 1
+#if _MSC_VER
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+#if __GNUC__
+#define ATHENA_TARGET(isa) __attribute__((target(isa)))
+#else
+#define ATHENA_TARGET(isa)
+#endif
+#elif __ARM_NEON
+#define ATHENA_SWAP_NEON 1
+#include <arm_neon.h>
+#endif
+
 namespace athena::utility {
 
 void fillRandom(uint8_t* rndArea, uint64_t count) {
@@ -192,4 +209,128 @@ std::wstring utf8ToWide(std::string_view src) {
   return retval;
 }
 
+namespace {
+template <typename T>
+void swapArrayScalar(T* data, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    if constexpr (sizeof(T) == 2)
+      data[i] = swapU16(data[i]);
+    else if constexpr (sizeof(T) == 4)
+      data[i] = swapU32(data[i]);
+    else
+      data[i] = swapU64(data[i]);
+  }
+}
+
+#if ATHENA_SWAP_X86
+// pshufb masks reversing each 2, 4 or 8 byte lane of a 16 byte vector
+template <typename T>
+__m128i swapMask128() {
+  if constexpr (sizeof(T) == 2)
+    return _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+  else if constexpr (sizeof(T) == 4)
+    return _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  else
+    return _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+}
+
+template <typename T>
+ATHENA_TARGET("ssse3")
+void swapArraySSSE3(T* data, size_t count) {
+  constexpr size_t PerVec = 16 / sizeof(T);
+  const __m128i mask = swapMask128<T>();
+  size_t i = 0;
+  for (; i + PerVec <= count; i += PerVec) {
+    __m128i* p = reinterpret_cast<__m128i*>(data + i);
+    _mm_storeu_si128(p, _mm_shuffle_epi8(_mm_loadu_si128(p), mask));
+  }
+  swapArrayScalar(data + i, count - i);
+}
+
+template <typename T>
+ATHENA_TARGET("avx2")
+void swapArrayAVX2(T* data, size_t count) {
+  constexpr size_t PerVec = 32 / sizeof(T);
+  // vpshufb shuffles within each 128-bit lane, so the same mask is used for both halves
+  const __m256i mask = _mm256_broadcastsi128_si256(swapMask128<T>());
+  size_t i = 0;
+  for (; i + PerVec <= count; i += PerVec) {
+    __m256i* p = reinterpret_cast<__m256i*>(data + i);
+    _mm256_storeu_si256(p, _mm256_shuffle_epi8(_mm256_loadu_si256(p), mask));
+  }
+  swapArrayScalar(data + i, count - i);
+}
+
+enum class SwapISA { Scalar, SSSE3, AVX2 };
+
+SwapISA detectSwapISA() {
+#if _MSC_VER
+  int info[4];
+  __cpuid(info, 0);
+  const int maxLeaf = info[0];
+  __cpuid(info, 1);
+  const bool ssse3 = (info[2] & (1 << 9)) != 0;
+  // AVX2 also needs the OS to save YMM state (OSXSAVE + XCR0 bits 1 and 2)
+  bool avx2 = false;
+  if (maxLeaf >= 7 && (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6) {
+    __cpuidex(info, 7, 0);
+    avx2 = (info[1] & (1 << 5)) != 0;
+  }
+#else
+  __builtin_cpu_init();
+  const bool ssse3 = __builtin_cpu_supports("ssse3");
+  const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+  if (avx2)
+    return SwapISA::AVX2;
+  if (ssse3)
+    return SwapISA::SSSE3;
+  return SwapISA::Scalar;
+}
+
+template <typename T>
+void swapArrayDispatch(T* data, size_t count) {
+  static const SwapISA isa = detectSwapISA();
+  switch (isa) {
+  case SwapISA::AVX2:
+    swapArrayAVX2(data, count);
+    break;
+  case SwapISA::SSSE3:
+    swapArraySSSE3(data, count);
+    break;
+  default:
+    swapArrayScalar(data, count);
+    break;
+  }
+}
+#elif ATHENA_SWAP_NEON
+template <typename T>
+void swapArrayDispatch(T* data, size_t count) {
+  constexpr size_t PerVec = 16 / sizeof(T);
+  uint8_t* bytes = reinterpret_cast<uint8_t*>(data);
+  size_t i = 0;
+  for (; i + PerVec <= count; i += PerVec) {
+    uint8x16_t v = vld1q_u8(bytes + i * sizeof(T));
+    if constexpr (sizeof(T) == 2)
+      v = vrev16q_u8(v);
+    else if constexpr (sizeof(T) == 4)
+      v = vrev32q_u8(v);
+    else
+      v = vrev64q_u8(v);
+    vst1q_u8(bytes + i * sizeof(T), v);
+  }
+  swapArrayScalar(data + i, count - i);
+}
+#else
+template <typename T>
+void swapArrayDispatch(T* data, size_t count) {
+  swapArrayScalar(data, count);
+}
+#endif
+} // Anonymous namespace
+
+void swapArrayU16(uint16_t* data, size_t count) { swapArrayDispatch(data, count); }
+void swapArrayU32(uint32_t* data, size_t count) { swapArrayDispatch(data, count); }
+void swapArrayU64(uint64_t* data, size_t count) { swapArrayDispatch(data, count); }
+
 } // namespace athena::utility
@@ -6,7 +6,8 @@
 
 namespace athena::io {
 
-void VectorWriter::seek(int64_t position, SeekOrigin origin) {
+template <class Allocator>
+void BasicVectorWriter<Allocator>::seek(int64_t position, SeekOrigin origin) {
   switch (origin) {
   case SeekOrigin::Begin:
     if (position < 0) {
@@ -52,7 +53,8 @@ void VectorWriter::seek(int64_t position, SeekOrigin origin) {
   }
 }
 
-void VectorWriter::writeUBytes(const uint8_t* data, uint64_t length) {
+template <class Allocator>
+void BasicVectorWriter<Allocator>::writeUBytes(const uint8_t* data, uint64_t length) {
   if (!data) {
     atError("data cannnot be NULL");
     setError();
@@ -75,4 +77,24 @@ void VectorWriter::writeUBytes(const uint8_t* data, uint64_t length) {
   }
 }
 
+template <class Allocator>
+void BasicVectorWriter<Allocator>::writeGather(std::span<const GatherBuffer> bufs) {
+  size_t total = 0;
+  for (const GatherBuffer& buf : bufs)
+    total += buf.len;
+
+  if (m_position + total > m_data.size())
+    m_data.resize(m_position + total);
+
+  for (const GatherBuffer& buf : bufs) {
+    if (!buf.len)
+      continue;
+    memmove(&m_data[m_position], buf.data, buf.len);
+    m_position += buf.len;
+  }
+}
+
+template class BasicVectorWriter<std::allocator<uint8_t>>;
+template class BasicVectorWriter<std::pmr::polymorphic_allocator<uint8_t>>;
+
 } // namespace athena::io
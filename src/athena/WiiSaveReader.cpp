@@ -5,6 +5,7 @@
 #include "athena/WiiBanner.hpp"
 #include "athena/Utility.hpp"
 #include "athena/FileWriter.hpp"
+#include "athena/SubStreamReader.hpp"
 #include "md5.h"
 #include "aes.hpp"
 #include "ec.hpp"
@@ -82,12 +83,8 @@ std::unique_ptr<WiiSave> WiiSaveReader::readSave() {
 }
 
 WiiBanner* WiiSaveReader::readBanner() {
-  uint8_t* dec = new uint8_t[0xF0C0];
-  memset(dec, 0, 0xF0C0);
-  std::unique_ptr<uint8_t[]> buf = readUBytes(0xF0C0);
-  uint8_t* oldData = data();
-  uint64_t oldPos = position();
-  uint64_t oldLen = length();
+  std::unique_ptr<uint8_t[]> dec(new uint8_t[0xF0C0]);
+  std::span<const uint8_t> buf = readView(0xF0C0);
   uint64_t gameId;
   uint32_t bannerSize;
   uint8_t permissions;
@@ -96,25 +93,29 @@ WiiBanner* WiiSaveReader::readBanner() {
   uint8_t tmpIV[16];
   memcpy(tmpIV, SD_IV, 16);
 
+  if (buf.size() != 0xF0C0) {
+    atError("Banner exceeds save bounds");
+    return nullptr;
+  }
+
   std::cout << "Decrypting: banner.bin...";
   std::unique_ptr<IAES> aes = NewAES();
   aes->setKey(SD_KEY);
-  aes->decrypt(tmpIV, buf.get(), dec, 0xF0C0);
+  aes->decrypt(tmpIV, buf.data(), dec.get(), 0xF0C0);
   std::cout << "done" << std::endl;
 
   memset(md5, 0, 16);
   memset(md5Calc, 0, 16);
   // Read in the MD5 sum
-  memcpy(md5, (dec + 0x0E), 0x10);
+  memcpy(md5, (dec.get() + 0x0E), 0x10);
   // Write the blanker to the buffer
-  memcpy((dec + 0x0E), MD5_BLANKER, 0x10);
-  MD5Hash::MD5(md5Calc, dec, 0xF0C0);
+  memcpy((dec.get() + 0x0E), MD5_BLANKER, 0x10);
+  MD5Hash::MD5(md5Calc, dec.get(), 0xF0C0);
 
   // Compare the Calculated MD5 to the one from the file.
   // This needs to be done incase the file is corrupted.
   if (memcmp(md5, md5Calc, 0x10)) {
     std::cerr << "MD5 Mismatch" << std::endl;
-    // Make sure to reset m_reader values back to the old ones.
     std::cerr << "MD5 provided:   ";
 
     for (int i = 0; i < 16; ++i)
@@ -128,22 +129,21 @@ WiiBanner* WiiSaveReader::readBanner() {
       std::cerr << std::hex << (int)(md5Calc[i]);
 
     std::cerr << std::endl;
-    setData(oldData, oldLen);
-    seek(oldPos, SeekOrigin::Begin);
     atError("MD5 Mismatch");
     return nullptr;
   }
 
-  // Set the binary reader buffer;
-  setData(dec, 0xF0C0);
+  // Read the decrypted banner through its own window, leaving this reader's buffer and position alone
+  SubStreamReader in({dec.get(), 0xF0C0});
+  in.setEndian(Endian::Big);
   // Start reading the header
-  gameId = readUint64();
-  bannerSize = readUint32();
-  permissions = readByte();
-  /*    unk =*/readByte();
-  seek(0x10);
+  gameId = in.readUint64();
+  bannerSize = in.readUint32();
+  permissions = in.readByte();
+  /*    unk =*/in.readByte();
+  in.seek(0x10);
   // skip padding
-  seek(2);
+  in.seek(2);
 
   int magic;
   int flags;
@@ -151,44 +151,41 @@ WiiBanner* WiiSaveReader::readBanner() {
   std::u16string gameTitle;
   std::u16string subTitle;
 
-  magic = readUint32();
+  magic = in.readUint32();
 
   // Ensure that the header magic is valid.
   if (magic != 0x5749424E) {
-    // Make sure to reset m_reader values back to the old ones.
-    setData(oldData, oldLen);
-    seek(oldPos, SeekOrigin::Begin);
     atError("Invalid Header Magic");
     return nullptr;
   }
 
-  flags = readUint32();
-  animSpeed = readUint16();
-  seek(22);
+  flags = in.readUint32();
+  animSpeed = in.readUint16();
+  in.seek(22);
 
-  gameTitle = readU16StringBig();
+  gameTitle = in.readU16StringBig();
 
-  if (position() != 0x0080)
-    seek(0x0080, SeekOrigin::Begin);
+  if (in.position() != 0x0080)
+    in.seek(0x0080, SeekOrigin::Begin);
 
-  subTitle = readU16StringBig();
+  subTitle = in.readU16StringBig();
 
-  if (position() != 0x00C0)
-    seek(0x00C0, SeekOrigin::Begin);
+  if (in.position() != 0x00C0)
+    in.seek(0x00C0, SeekOrigin::Begin);
 
   WiiBanner* banner = new WiiBanner;
   banner->setGameID(gameId);
   banner->setTitle(gameTitle);
   banner->setSubtitle(subTitle);
   banner->setBannerSize(bannerSize);
-  WiiImage* bannerImage = readImage(192, 64);
+  WiiImage* bannerImage = readImage(in, 192, 64);
   banner->setBannerImage(bannerImage);
   banner->setAnimationSpeed(animSpeed);
   banner->setPermissions(permissions);
   banner->setFlags(flags);
 
   if (banner->bannerSize() == 0x72a0) {
-    WiiImage* icon = readImage(48, 48);
+    WiiImage* icon = readImage(in, 48, 48);
 
     if (icon)
       banner->addIcon(icon);
@@ -196,7 +193,7 @@ WiiBanner* WiiSaveReader::readBanner() {
       std::cerr << "Warning: Icon empty, skipping" << std::endl;
   } else {
     for (int i = 0; i < 8; i++) {
-      WiiImage* icon = readImage(48, 48);
+      WiiImage* icon = readImage(in, 48, 48);
 
       if (icon)
         banner->addIcon(icon);
@@ -205,13 +202,11 @@ WiiBanner* WiiSaveReader::readBanner() {
     }
   }
 
-  setData(oldData, oldLen);
-  seek(oldPos, SeekOrigin::Begin);
   return banner;
 }
 
-WiiImage* WiiSaveReader::readImage(uint32_t width, uint32_t height) {
-  std::unique_ptr<uint8_t[]> image = readUBytes(width * height * 2);
+WiiImage* WiiSaveReader::readImage(IStreamReader& in, uint32_t width, uint32_t height) {
+  std::unique_ptr<uint8_t[]> image = in.readUBytes(width * height * 2);
 
   if (!utility::isEmpty((int8_t*)image.get(), width * height * 2))
     return new WiiImage(width, height, std::move(image));
@@ -238,25 +233,32 @@ WiiFile* WiiSaveReader::readFile() {
   permissions = readByte();
   attributes = readByte();
   type = (WiiFile::Type)readByte();
-  name = std::string((const char*)readBytes(0x45).get());
+  std::span<const uint8_t> nameView = readView(0x45);
+  name = std::string((const char*)nameView.data(), strnlen((const char*)nameView.data(), nameView.size()));
   ret = new WiiFile(std::string(name));
   ret->setPermissions(permissions);
   ret->setAttributes(attributes);
   ret->setType((WiiFile::Type)type);
-  std::unique_ptr<uint8_t[]> iv = readUBytes(0x10);
+  std::span<const uint8_t> iv = readView(0x10);
   seek(0x20);
 
   if (type == WiiFile::File) {
     // Read file data
     int roundedLen = (fileLen + 63) & ~63;
-    std::unique_ptr<uint8_t[]> filedata = readUBytes(roundedLen);
+    std::span<const uint8_t> filedata = readView(roundedLen);
+
+    if (iv.size() != 0x10 || filedata.size() != uint64_t(roundedLen)) {
+      delete ret;
+      atError("File data exceeds save bounds");
+      return nullptr;
+    }
 
     // Decrypt file
     std::cout << "Decrypting: " << ret->filename() << "...";
     uint8_t* decData = new uint8_t[roundedLen];
     std::unique_ptr<IAES> aes = NewAES();
     aes->setKey(SD_KEY);
-    aes->decrypt(iv.get(), filedata.get(), decData, roundedLen);
+    aes->decrypt(iv.data(), filedata.data(), decData, roundedLen);
     ret->setData(decData);
     ret->setLength(fileLen);
     std::cout << "done" << std::endl;
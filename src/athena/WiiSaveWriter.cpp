@@ -116,60 +116,65 @@ void WiiSaveWriter::writeBanner(WiiBanner* banner) {
 
   delete[] tmpIcon; // delete tmp buffer;
 
-  uint8_t* hash = new uint8_t[0x10];
-  MD5Hash::MD5(hash, (uint8_t*)data(), 0xF0C0);
+  // Hash and encrypt the banner in place rather than through copies from data()
+  uint8_t hash[0x10];
+  MD5Hash::MD5(hash, m_data, 0xF0C0);
   seek(0x0E, SeekOrigin::Begin);
   writeBytes((int8_t*)hash, 0x10);
 
   std::unique_ptr<IAES> aes = NewAES();
   aes->setKey(SD_KEY);
-  uint8_t data[0xF0C0];
-  memcpy(data, this->data(), 0xF0C0);
   uint8_t tmpIV[26];
   memcpy(tmpIV, SD_IV, 16);
-  aes->encrypt(tmpIV, data, data, 0xF0C0);
+  aes->encrypt(tmpIV, m_data, m_data, 0xF0C0);
 
-  seek(0, SeekOrigin::Begin);
-  writeBytes((int8_t*)data, 0xF0C0);
   seek(0xF0C0, SeekOrigin::Begin);
 }
 
 uint32_t WiiSaveWriter::writeFile(WiiFile* file) {
   uint32_t ret = 0x80;
 
-  // Write the File magic
-  writeUint32(0x03ADF17E);
-  writeUint32(file->length());
-  writeByte(file->permissions());
-  writeByte(file->attributes());
-  writeByte(file->type());
+  // File magic, length, permissions, attributes and type
+  uint8_t header[0x0B];
+  uint32_t magic = 0x03ADF17E;
+  uint32_t length = file->length();
+  utility::BigUint32(magic);
+  utility::BigUint32(length);
+  memcpy(header, &magic, 4);
+  memcpy(header + 4, &length, 4);
+  header[8] = file->permissions();
+  header[9] = file->attributes();
+  header[10] = file->type();
 
   uint8_t name[0x45];
   utility::fillRandom(name, 0x45);
   memcpy(name, file->fullpath().c_str(), file->fullpath().size());
   name[file->fullpath().size()] = '\0';
-  writeBytes((int8_t*)name, 0x45);
   uint8_t iv[16];
   utility::fillRandom(iv, 0x10);
-  writeBytes((int8_t*)iv, 0x10);
   uint8_t crap[0x20];
   utility::fillRandom(crap, 0x20);
-  writeBytes((int8_t*)crap, 0x20);
 
+  std::unique_ptr<uint8_t[]> data;
+  int roundedSize = 0;
   if (file->type() == WiiFile::File) {
-    int roundedSize = (file->length() + 63) & ~63;
-    uint8_t* data = new uint8_t[roundedSize];
-    memset(data, 0, roundedSize);
+    roundedSize = (file->length() + 63) & ~63;
+    data.reset(new uint8_t[roundedSize]);
+    memset(data.get(), 0, roundedSize);
 
     std::unique_ptr<IAES> aes = NewAES();
     aes->setKey(SD_KEY);
-    aes->encrypt(iv, file->data(), data, roundedSize);
-
-    writeBytes((int8_t*)data, roundedSize);
+    aes->encrypt(iv, file->data(), data.get(), roundedSize);
     ret += roundedSize;
-    delete[] data;
   }
 
+  // Header, name, IV, padding and payload go out as a single write
+  const GatherBuffer segments[] = {
+      {header, sizeof(header)}, {name, sizeof(name)}, {iv, sizeof(iv)},
+      {crap, sizeof(crap)},     {data.get(), size_t(roundedSize)},
+  };
+  writeGather(segments);
+
   return ret;
 }
 
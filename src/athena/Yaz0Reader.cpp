@@ -0,0 +1,225 @@
+#include "athena/Yaz0Reader.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "LZ77/LZCopy.hpp"
+
+namespace athena::io {
+Yaz0Reader::Yaz0Reader(IStreamReader& source, uint32_t chunkSize, bool globalErr)
+: m_source(source), m_chunkSize(std::max(chunkSize, 1u)), m_globalErr(globalErr) {
+  m_outCapacity = WindowSize + m_chunkSize;
+  m_out.reset(new uint8_t[m_outCapacity + LZCopySlack]);
+  setGetArea(m_out.get(), m_out.get(), m_out.get());
+
+  uint8_t header[16];
+  if (m_source.length() - std::min(m_source.position(), m_source.length()) < sizeof(header)) {
+    fail("Not a valid Yaz0 stream");
+    return;
+  }
+  m_source.readUBytesToBuf(header, sizeof(header));
+  if (std::memcmp(header, "Yaz0", 4) != 0) {
+    fail("Not a valid Yaz0 stream");
+    return;
+  }
+
+  uint32_t size;
+  std::memcpy(&size, header + 4, 4);
+  m_length = utility::BigUint32(size);
+  m_dataStart = m_source.position();
+}
+
+void Yaz0Reader::fail(const char* msg) {
+  if (m_globalErr)
+    atError("{}", msg);
+  setError();
+  m_failed = true;
+}
+
+void Yaz0Reader::reset() {
+  // The header never parsed, there is nothing to rewind to
+  if (m_dataStart == 0)
+    return;
+
+  m_source.seek(int64_t(m_dataStart), SeekOrigin::Begin);
+  m_inPos = m_inLen = 0;
+  m_outOffset = m_produced = 0;
+  m_copyDist = m_copyLen = 0;
+  m_code = m_codeBits = 0;
+  m_failed = false;
+  setGetArea(m_out.get(), m_out.get(), m_out.get());
+}
+
+bool Yaz0Reader::nextIn(uint8_t& val) {
+  if (m_inPos == m_inLen) {
+    const uint64_t avail = m_source.length() - std::min(m_source.position(), m_source.length());
+    const uint64_t want = std::min(uint64_t(InputSize), avail);
+    m_inLen = want ? uint32_t(m_source.readUBytesToBuf(m_in, want)) : 0;
+    m_inPos = 0;
+    if (m_inLen == 0) {
+      fail("Yaz0 data ends unexpectedly");
+      return false;
+    }
+  }
+  val = m_in[m_inPos++];
+  return true;
+}
+
+uint64_t Yaz0Reader::decodeChunk(uint64_t want) {
+  // Keep the last WindowSize bytes of output as history for back-references, along with any unread output
+  const uint64_t pos = position();
+  const size_t end = size_t(m_getEnd - m_out.get());
+  const size_t unread = size_t(m_getEnd - m_getCur);
+  const size_t keepFrom = std::min(size_t(m_getCur - m_out.get()), end - std::min(end, size_t(WindowSize)));
+  const size_t keep = end - keepFrom;
+  want = std::min(want, m_length - m_produced);
+  if (keep + want > m_outCapacity) {
+    // Grow the buffer for a view longer than a chunk
+    std::unique_ptr<uint8_t[]> grown(new uint8_t[keep + want + LZCopySlack]);
+    std::memcpy(grown.get(), m_out.get() + keepFrom, keep);
+    m_out = std::move(grown);
+    m_outCapacity = keep + want;
+  } else {
+    std::memmove(m_out.get(), m_out.get() + keepFrom, keep);
+  }
+  uint8_t* const start = m_out.get() + keep;
+  uint8_t* out = start;
+  uint8_t* const outEnd = start + want;
+
+  while (out < outEnd && !m_failed) {
+    if (m_copyLen) {
+      // The buffer has LZCopySlack bytes spare past the chunk for the wide copy to run over
+      const uint32_t n = std::min(m_copyLen, uint32_t(outEnd - out));
+      lzCopyMatch(out, m_copyDist, n);
+      out += n;
+      m_copyLen -= n;
+      continue;
+    }
+
+    if (m_codeBits == 0) {
+      if (!nextIn(m_code))
+        break;
+      m_codeBits = 8;
+    }
+
+    if (m_code & 0x80) {
+      // straight copy
+      if (!nextIn(*out))
+        break;
+      ++out;
+    } else {
+      // RLE part
+      uint8_t byte1, byte2;
+      if (!nextIn(byte1) || !nextIn(byte2))
+        break;
+
+      uint32_t numBytes = byte1 >> 4;
+      if (numBytes == 0) {
+        uint8_t byte3;
+        if (!nextIn(byte3))
+          break;
+        numBytes = byte3 + 0x12;
+      } else {
+        numBytes += 2;
+      }
+
+      m_copyDist = (((byte1 & 0xF) << 8) | byte2) + 1;
+      if (m_copyDist > uint64_t(out - m_out.get())) {
+        fail("Yaz0 back-reference before start of data");
+        break;
+      }
+      m_copyLen = numBytes;
+    }
+
+    m_code <<= 1;
+    --m_codeBits;
+  }
+
+  const uint64_t got = uint64_t(out - start);
+  m_outOffset = pos;
+  m_produced += got;
+  setGetArea(start - unread, start - unread, out);
+
+  // Hand unused input back so the source is left just past the Yaz0 data
+  if (m_produced == m_length && m_inPos != m_inLen) {
+    m_source.seek(-int64_t(m_inLen - m_inPos), SeekOrigin::Current);
+    m_inPos = m_inLen;
+  }
+  return got;
+}
+
+void Yaz0Reader::skip(uint64_t count) {
+  while (count) {
+    const uint64_t avail = uint64_t(m_getEnd - m_getCur);
+    if (avail == 0) {
+      if (decodeChunk(m_chunkSize) == 0)
+        break;
+      continue;
+    }
+    const uint64_t n = std::min(avail, count);
+    m_getCur += n;
+    count -= n;
+  }
+}
+
+void Yaz0Reader::seek(int64_t pos, SeekOrigin origin) {
+  int64_t target = 0;
+  switch (origin) {
+  case SeekOrigin::Begin:
+    target = pos;
+    break;
+  case SeekOrigin::Current:
+    target = int64_t(position()) + pos;
+    break;
+  case SeekOrigin::End:
+    target = int64_t(m_length) - pos;
+    break;
+  }
+
+  if (target < 0 || uint64_t(target) > m_length) {
+    if (m_globalErr)
+      atError("Position {:08X} outside stream bounds ", target);
+    setError();
+    return;
+  }
+
+  if (uint64_t(target) < position()) {
+    // Still inside the current chunk, otherwise start over
+    if (uint64_t(target) >= m_outOffset) {
+      m_getCur = m_getBegin + (uint64_t(target) - m_outOffset);
+      return;
+    }
+    reset();
+  }
+
+  skip(uint64_t(target) - position());
+}
+
+uint64_t Yaz0Reader::readUBytesToBuf(void* buf, uint64_t len) {
+  uint8_t* dst = static_cast<uint8_t*>(buf);
+  uint64_t rem = len;
+  while (rem) {
+    const uint64_t avail = uint64_t(m_getEnd - m_getCur);
+    if (avail == 0) {
+      if (decodeChunk(m_chunkSize) == 0)
+        break;
+      continue;
+    }
+    const uint64_t n = std::min(avail, rem);
+    std::memcpy(dst, m_getCur, n);
+    m_getCur += n;
+    dst += n;
+    rem -= n;
+  }
+
+  return uint64_t(dst - static_cast<uint8_t*>(buf));
+}
+
+std::span<const uint8_t> Yaz0Reader::peekView(uint64_t len) {
+  len = std::min(len, m_length - std::min(m_length, position()));
+  const uint64_t avail = uint64_t(m_getEnd - m_getCur);
+  if (avail < len && !m_failed)
+    decodeChunk(std::max(uint64_t(m_chunkSize), len - avail));
+  return {m_getCur, size_t(std::min(len, uint64_t(m_getEnd - m_getCur)))};
+}
+} // namespace athena::io
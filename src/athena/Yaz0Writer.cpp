@@ -0,0 +1,139 @@
+#include "athena/Yaz0Writer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace athena::io {
+Yaz0Writer::Yaz0Writer(IStreamWriter& sink, uint32_t uncompressedSize, bool globalErr)
+: m_sink(sink)
+, m_buf(new uint8_t[BufferSize])
+, m_headerPos(sink.position())
+, m_expectedSize(uncompressedSize)
+, m_globalErr(globalErr) {
+  m_group[0] = 0;
+  m_encoder.reset();
+
+  uint8_t header[16] = {'Y', 'a', 'z', '0'};
+  uint32_t size = uncompressedSize == UINT32_MAX ? 0 : uncompressedSize;
+  utility::BigUint32(size);
+  std::memcpy(header + 4, &size, 4);
+  m_sink.writeUBytes(header, sizeof(header));
+}
+
+Yaz0Writer::~Yaz0Writer() { finish(); }
+
+void Yaz0Writer::writeUBytes(const uint8_t* data, uint64_t len) {
+  if (m_finished) {
+    if (m_globalErr)
+      atError("Yaz0 stream is finished");
+    setError();
+    return;
+  }
+
+  m_position += len;
+  while (len) {
+    if (m_bufEnd == BufferSize) {
+      encode(false);
+
+      // Slide the window down by whole windows, keeping the match history and the unencoded tail
+      const uint32_t keepFrom = (m_encPos - std::min(m_encPos, WindowSize)) & ~(WindowSize - 1);
+      std::memmove(m_buf.get(), m_buf.get() + keepFrom, m_bufEnd - keepFrom);
+      m_encoder.slide(keepFrom);
+      m_encPos -= keepFrom;
+      m_bufEnd -= keepFrom;
+    }
+
+    const uint32_t n = uint32_t(std::min(len, uint64_t(BufferSize - m_bufEnd)));
+    std::memcpy(m_buf.get() + m_bufEnd, data, n);
+    m_bufEnd += n;
+    data += n;
+    len -= n;
+  }
+}
+
+void Yaz0Writer::seek(int64_t pos, SeekOrigin origin) {
+  int64_t delta = pos;
+  if (origin == SeekOrigin::Begin)
+    delta = pos - int64_t(m_position);
+  else if (origin == SeekOrigin::End)
+    delta = -pos;
+
+  if (delta < 0) {
+    if (m_globalErr)
+      atError("Cannot seek backwards in a Yaz0 stream");
+    setError();
+    return;
+  }
+
+  fill(uint8_t(0), uint64_t(delta));
+}
+
+void Yaz0Writer::encode(bool final) {
+  // Without the final flag leave enough input for both this position and the lookahead one to see a full match
+  const uint32_t limit = final ? m_bufEnd : (m_bufEnd > MaxMatch + 1 ? m_bufEnd - (MaxMatch + 1) : 0);
+  while (m_encPos < limit) {
+    uint32_t matchPos;
+    const uint32_t numBytes = m_encoder.nextOp(m_buf.get(), m_bufEnd, m_encPos, matchPos);
+    if (numBytes < 3) {
+      emitLiteral(m_buf[m_encPos]);
+      ++m_encPos;
+    } else {
+      const uint32_t len = std::min(numBytes, MaxMatch);
+      emitMatch(len, m_encPos - matchPos);
+      m_encPos += len;
+    }
+  }
+}
+
+void Yaz0Writer::emitLiteral(uint8_t val) {
+  m_group[0] |= 0x80 >> m_groupOps;
+  m_group[m_groupLen++] = val;
+  if (++m_groupOps == 8)
+    flushGroup();
+}
+
+void Yaz0Writer::emitMatch(uint32_t len, uint32_t dist) {
+  const uint32_t d = dist - 1;
+  if (len >= 0x12) {
+    // 3 byte encoding
+    m_group[m_groupLen++] = uint8_t(d >> 8);
+    m_group[m_groupLen++] = uint8_t(d & 0xFF);
+    m_group[m_groupLen++] = uint8_t(len - 0x12);
+  } else {
+    // 2 byte encoding
+    m_group[m_groupLen++] = uint8_t(((len - 2) << 4) | (d >> 8));
+    m_group[m_groupLen++] = uint8_t(d & 0xFF);
+  }
+  if (++m_groupOps == 8)
+    flushGroup();
+}
+
+void Yaz0Writer::flushGroup() {
+  if (m_groupOps == 0)
+    return;
+  m_sink.writeUBytes(m_group, m_groupLen);
+  m_group[0] = 0;
+  m_groupLen = 1;
+  m_groupOps = 0;
+}
+
+void Yaz0Writer::finish() {
+  if (m_finished)
+    return;
+
+  encode(true);
+  flushGroup();
+  m_finished = true;
+
+  if (m_expectedSize == UINT32_MAX) {
+    const uint64_t end = m_sink.position();
+    m_sink.seek(int64_t(m_headerPos + 4), SeekOrigin::Begin);
+    m_sink.writeUint32Big(uint32_t(m_position));
+    m_sink.seek(int64_t(end), SeekOrigin::Begin);
+  } else if (m_position != m_expectedSize) {
+    if (m_globalErr)
+      atError("Yaz0 stream was declared as {} bytes but {} were written", m_expectedSize, m_position);
+    setError();
+  }
+}
+} // namespace athena::io
@@ -4,6 +4,7 @@
 #include "athena/Checksums.hpp"
 #include "athena/Utility.hpp"
 
+#include <cstring>
 #include <iostream>
 #include <iomanip>
 
@@ -56,10 +57,16 @@ ZQuestFile* ZQuestFileReader::read() {
     seek(0x0A);
   }
 
-  std::unique_ptr<uint8_t[]> data = readUBytes(compressedLen); // compressedLen is always the total file size
+  // compressedLen is always the total file size
+  std::span<const uint8_t> payload = readView(compressedLen);
+
+  if (payload.size() != compressedLen) {
+    atError("Payload exceeds file bounds");
+    return nullptr;
+  }
 
   if (version >= ZQUEST_VERSION_CHECK(2, 0, 0)) {
-    if (checksum != athena::checksums::crc32(data.get(), compressedLen)) {
+    if (checksum != athena::checksums::crc32(payload.data(), compressedLen)) {
       atError("Checksum mismatch, data corrupt");
       return nullptr;
     }
@@ -69,17 +76,16 @@ ZQuestFile* ZQuestFileReader::read() {
     std::clog << " has no checksum field" << std::endl;
   }
 
+  auto data = std::make_unique<uint8_t[]>(uncompressedLen);
   if (compressedLen != uncompressedLen) {
-    uint8_t* dst = new uint8_t[uncompressedLen];
-    uint32_t dstLen = io::Compression::decompressZlib(data.get(), compressedLen, dst, uncompressedLen);
+    uint32_t dstLen = io::Compression::decompressZlib(payload.data(), compressedLen, data.get(), uncompressedLen);
 
     if (dstLen != uncompressedLen) {
-      delete[] dst;
       atError("Error decompressing data");
       return nullptr;
     }
-
-    data.reset(dst);
+  } else {
+    std::memcpy(data.get(), payload.data(), uncompressedLen);
   }
 
   return new ZQuestFile(game, BOM == 0xFEFF ? Endian::Big : Endian::Little, std::move(data), uncompressedLen,
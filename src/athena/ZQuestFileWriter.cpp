@@ -24,7 +24,7 @@ void ZQuestFileWriter::write(ZQuestFile* quest, bool compress) {
     uint8_t* compData =
         new uint8_t[quest->length() + 0x40]; // add 20 bytes because sometimes the file grows with compression
     compLen = quest->length() + 0x40;
-    compLen = io::Compression::compressZlib(questData, quest->length(), compData, compLen);
+    compLen = io::Compression::compressZlibParallel(questData, quest->length(), compData, compLen);
 
     // if the compressed data is the same length or larger than the original data, just store the original
     if (compLen >= quest->length() || compLen <= 0) {
@@ -0,0 +1,230 @@
+#include "athena/ZlibStreamReader.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <zlib.h>
+
+namespace athena::io {
+namespace {
+int windowBits(ZlibStreamReader::Format format) {
+  switch (format) {
+  case ZlibStreamReader::Format::Auto:
+  default:
+    // | 32 tells zlib to detect the zlib or gzip header itself
+    return MAX_WBITS | 32;
+  case ZlibStreamReader::Format::Zlib:
+    return MAX_WBITS;
+  case ZlibStreamReader::Format::Gzip:
+    return MAX_WBITS | 16;
+  case ZlibStreamReader::Format::Raw:
+    return -MAX_WBITS;
+  }
+}
+} // namespace
+
+ZlibStreamReader::ZlibStreamReader(IStreamReader& source, Format format, uint32_t chunkSize, bool globalErr)
+: m_source(source)
+, m_strm(std::make_unique<z_stream>())
+, m_chunkSize(std::max(chunkSize, 1u))
+, m_outCapacity(m_chunkSize)
+, m_sourceStart(source.position())
+, m_format(format)
+, m_globalErr(globalErr) {
+  m_in.reset(new uint8_t[m_chunkSize]);
+  m_out.reset(new uint8_t[m_outCapacity]);
+  setGetArea(m_out.get(), m_out.get(), m_out.get());
+
+  if (inflateInit2(m_strm.get(), windowBits(m_format)) != Z_OK) {
+    if (m_globalErr)
+      atError("Unable to initialize inflate");
+    setError();
+    return;
+  }
+  m_initialized = true;
+}
+
+ZlibStreamReader::~ZlibStreamReader() {
+  if (m_initialized)
+    inflateEnd(m_strm.get());
+}
+
+void ZlibStreamReader::reset() {
+  if (!m_initialized)
+    return;
+
+  m_source.seek(int64_t(m_sourceStart), SeekOrigin::Begin);
+  inflateReset(m_strm.get());
+  m_strm->avail_in = 0;
+  m_produced = 0;
+  m_outOffset = 0;
+  m_finished = false;
+  setGetArea(m_out.get(), m_out.get(), m_out.get());
+}
+
+uint64_t ZlibStreamReader::inflateInto(uint8_t* dst, uint64_t len) {
+  if (!m_initialized)
+    return 0;
+
+  z_stream& strm = *m_strm;
+  uint8_t* out = dst;
+  uint64_t rem = len;
+  while (rem && !m_finished) {
+    if (strm.avail_in == 0) {
+      const uint64_t avail = m_source.length() - std::min(m_source.position(), m_source.length());
+      const uint64_t want = std::min(uint64_t(m_chunkSize), avail);
+      const uint64_t got = want ? m_source.readUBytesToBuf(m_in.get(), want) : 0;
+      if (got == 0) {
+        if (m_globalErr)
+          atError("Compressed data ends unexpectedly");
+        setError();
+        m_finished = true;
+        break;
+      }
+      strm.next_in = m_in.get();
+      strm.avail_in = uInt(got);
+    }
+
+    strm.next_out = out;
+    strm.avail_out = uInt(std::min(rem, uint64_t(UINT32_MAX)));
+    const int ret = inflate(&strm, Z_NO_FLUSH);
+    const uint64_t produced = uint64_t(strm.next_out - out);
+    out += produced;
+    rem -= produced;
+    m_produced += produced;
+
+    if (ret == Z_STREAM_END) {
+      m_finished = true;
+      m_length = m_produced;
+      // Hand unused input back so the source is left just past the compressed data
+      if (strm.avail_in)
+        m_source.seek(-int64_t(strm.avail_in), SeekOrigin::Current);
+      strm.avail_in = 0;
+    } else if (ret != Z_OK && !(ret == Z_BUF_ERROR && strm.avail_in == 0)) {
+      if (m_globalErr)
+        atError("Inflate failed: {}", strm.msg ? strm.msg : "unknown error");
+      setError();
+      m_finished = true;
+    }
+  }
+
+  return uint64_t(out - dst);
+}
+
+uint64_t ZlibStreamReader::fillChunk(uint64_t want) {
+  // Keep any unread output in front of the new data, growing the buffer for views longer than it
+  const uint64_t pos = position();
+  const uint64_t unread = uint64_t(m_getEnd - m_getCur);
+  if (unread + want > m_outCapacity) {
+    const uint64_t capacity = std::min(unread + want, std::max(m_outCapacity * 2, unread + m_chunkSize));
+    std::unique_ptr<uint8_t[]> grown(new uint8_t[capacity]);
+    std::memcpy(grown.get(), m_getCur, unread);
+    m_out = std::move(grown);
+    m_outCapacity = capacity;
+  } else {
+    std::memmove(m_out.get(), m_getCur, unread);
+  }
+
+  m_outOffset = pos;
+  const uint64_t got = inflateInto(m_out.get() + unread, m_outCapacity - unread);
+  setGetArea(m_out.get(), m_out.get(), m_out.get() + unread + got);
+  return got;
+}
+
+void ZlibStreamReader::skip(uint64_t count) {
+  while (count) {
+    const uint64_t avail = uint64_t(m_getEnd - m_getCur);
+    if (avail == 0) {
+      if (fillChunk(m_chunkSize) == 0)
+        break;
+      continue;
+    }
+    const uint64_t n = std::min(avail, count);
+    m_getCur += n;
+    count -= n;
+  }
+}
+
+void ZlibStreamReader::seek(int64_t pos, SeekOrigin origin) {
+  const uint64_t curPos = position();
+  int64_t target = 0;
+  switch (origin) {
+  case SeekOrigin::Begin:
+    target = pos;
+    break;
+  case SeekOrigin::Current:
+    target = int64_t(curPos) + pos;
+    break;
+  case SeekOrigin::End:
+    // The length is only known at the end of the stream
+    if (m_length == UINT64_MAX)
+      skip(UINT64_MAX);
+    target = int64_t(m_length) - pos;
+    break;
+  }
+
+  if (target < 0) {
+    if (m_globalErr)
+      atError("Position {:08X} outside stream bounds ", target);
+    setError();
+    return;
+  }
+
+  if (uint64_t(target) < position()) {
+    // Still inside the current chunk, otherwise start over
+    if (uint64_t(target) >= m_outOffset) {
+      m_getCur = m_getBegin + (uint64_t(target) - m_outOffset);
+      return;
+    }
+    reset();
+  }
+
+  skip(uint64_t(target) - position());
+  if (position() != uint64_t(target)) {
+    if (m_globalErr)
+      atError("Position {:08X} outside stream bounds ", target);
+    setError();
+  }
+}
+
+uint64_t ZlibStreamReader::readUBytesToBuf(void* buf, uint64_t len) {
+  uint8_t* dst = static_cast<uint8_t*>(buf);
+  uint64_t rem = len;
+  while (rem) {
+    const uint64_t avail = uint64_t(m_getEnd - m_getCur);
+    if (avail) {
+      const uint64_t n = std::min(avail, rem);
+      std::memcpy(dst, m_getCur, n);
+      m_getCur += n;
+      dst += n;
+      rem -= n;
+      continue;
+    }
+
+    // Large reads inflate straight into the caller's buffer
+    if (rem >= m_chunkSize) {
+      const uint64_t got = inflateInto(dst, rem);
+      m_outOffset = m_produced;
+      setGetArea(m_out.get(), m_out.get(), m_out.get());
+      dst += got;
+      rem -= got;
+      if (got == 0)
+        break;
+      continue;
+    }
+
+    if (fillChunk(m_chunkSize) == 0)
+      break;
+  }
+
+  return uint64_t(dst - static_cast<uint8_t*>(buf));
+}
+
+std::span<const uint8_t> ZlibStreamReader::peekView(uint64_t len) {
+  while (uint64_t(m_getEnd - m_getCur) < len && !m_finished) {
+    if (fillChunk(len - uint64_t(m_getEnd - m_getCur)) == 0)
+      break;
+  }
+  return {m_getCur, size_t(std::min(len, uint64_t(m_getEnd - m_getCur)))};
+}
+} // namespace athena::io
@@ -0,0 +1,137 @@
+#include "athena/ZlibStreamWriter.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <zlib.h>
+
+namespace athena::io {
+ZlibStreamWriter::ZlibStreamWriter(IStreamWriter& sink, int32_t level, Format format, uint32_t chunkSize,
+                                   bool globalErr)
+: m_sink(sink), m_strm(std::make_unique<z_stream>()), m_chunkSize(std::max(chunkSize, 1u)), m_globalErr(globalErr) {
+  m_in.reset(new uint8_t[m_chunkSize]);
+  m_out.reset(new uint8_t[m_chunkSize]);
+
+  int bits = MAX_WBITS;
+  if (format == Format::Gzip)
+    bits |= 16;
+  else if (format == Format::Raw)
+    bits = -MAX_WBITS;
+
+  if (deflateInit2(m_strm.get(), level, Z_DEFLATED, bits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    if (m_globalErr)
+      atError("Unable to initialize deflate");
+    setError();
+    return;
+  }
+  m_initialized = true;
+}
+
+ZlibStreamWriter::~ZlibStreamWriter() {
+  if (!m_initialized)
+    return;
+  finish();
+  deflateEnd(m_strm.get());
+}
+
+void ZlibStreamWriter::deflateBuffer(const uint8_t* data, uint64_t len, int flush) {
+  z_stream& strm = *m_strm;
+  do {
+    const uint64_t slice = std::min(len, uint64_t(UINT32_MAX));
+    strm.next_in = const_cast<Bytef*>(data);
+    strm.avail_in = uInt(slice);
+    data += slice;
+    len -= slice;
+    const int sliceFlush = len ? Z_NO_FLUSH : flush;
+
+    // Drain output a chunk at a time until deflate has consumed the slice and has nothing left to say
+    do {
+      strm.next_out = m_out.get();
+      strm.avail_out = m_chunkSize;
+      const int ret = deflate(&strm, sliceFlush);
+      if (ret == Z_STREAM_ERROR) {
+        if (m_globalErr)
+          atError("Deflate failed");
+        setError();
+        return;
+      }
+      const uint32_t have = m_chunkSize - strm.avail_out;
+      if (have)
+        m_sink.writeUBytes(m_out.get(), have);
+    } while (strm.avail_out == 0);
+  } while (len);
+}
+
+void ZlibStreamWriter::writeUBytes(const uint8_t* data, uint64_t len) {
+  if (!m_initialized || m_finished) {
+    if (m_globalErr)
+      atError("Compressed stream is finished");
+    setError();
+    return;
+  }
+
+  m_position += len;
+
+  // Top up the pending chunk first, then deflate large writes straight from the caller's buffer
+  if (m_inLen) {
+    const uint32_t n = uint32_t(std::min(len, uint64_t(m_chunkSize - m_inLen)));
+    std::memcpy(m_in.get() + m_inLen, data, n);
+    m_inLen += n;
+    data += n;
+    len -= n;
+    if (m_inLen < m_chunkSize)
+      return;
+    deflateBuffer(m_in.get(), m_inLen, Z_NO_FLUSH);
+    m_inLen = 0;
+  }
+
+  if (len >= m_chunkSize) {
+    deflateBuffer(data, len, Z_NO_FLUSH);
+    return;
+  }
+
+  std::memcpy(m_in.get(), data, len);
+  m_inLen = uint32_t(len);
+}
+
+void ZlibStreamWriter::seek(int64_t pos, SeekOrigin origin) {
+  int64_t delta = pos;
+  if (origin == SeekOrigin::Begin)
+    delta = pos - int64_t(m_position);
+  else if (origin == SeekOrigin::End)
+    delta = -pos;
+
+  if (delta < 0) {
+    if (m_globalErr)
+      atError("Cannot seek backwards in a compressed stream");
+    setError();
+    return;
+  }
+
+  fill(uint8_t(0), uint64_t(delta));
+}
+
+void ZlibStreamWriter::flush() {
+  if (!m_initialized || m_finished)
+    return;
+  deflateBuffer(m_in.get(), m_inLen, Z_SYNC_FLUSH);
+  m_inLen = 0;
+}
+
+void ZlibStreamWriter::finish() {
+  if (!m_initialized || m_finished)
+    return;
+  deflateBuffer(m_in.get(), m_inLen, Z_FINISH);
+  m_inLen = 0;
+  m_finished = true;
+}
+
+void ZlibStreamWriter::reset() {
+  if (!m_initialized)
+    return;
+  finish();
+  deflateReset(m_strm.get());
+  m_position = 0;
+  m_finished = false;
+}
+} // namespace athena::io
@@ -0,0 +1,85 @@
+// Trains a zlib preset dictionary from sample files and reports how much it saves on them
+//
+//   athena-zdict [-s maxSize] [-l level] -o dictionary.bin sample...
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <athena/Compression.hpp>
+#include <athena/FileReader.hpp>
+#include <athena/FileWriter.hpp>
+
+using namespace athena::io;
+
+static void usage() {
+  std::fprintf(stderr, "usage: athena-zdict [-s maxSize] [-l level] -o dictionary.bin sample...\n"
+                       "  -s  Dictionary size limit in bytes, at most 32768 (default)\n"
+                       "  -l  zlib level used to report the savings, 9 by default\n");
+}
+
+static uint64_t compressedSize(Compression::ZlibContext& ctx, const std::vector<std::vector<uint8_t>>& samples) {
+  uint64_t total = 0;
+  std::vector<uint8_t> out;
+  for (const std::vector<uint8_t>& sample : samples) {
+    out.resize(ctx.compressBound(uint32_t(sample.size())));
+    const int32_t len = ctx.compress(sample, out);
+    total += len > 0 ? uint64_t(len) : sample.size();
+  }
+  return total;
+}
+
+int main(int argc, char** argv) {
+  uint32_t maxSize = 0x8000;
+  int32_t level = 9;
+  const char* output = nullptr;
+  std::vector<std::vector<uint8_t>> samples;
+  uint64_t sampleBytes = 0;
+
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "-s") && i + 1 < argc) {
+      maxSize = uint32_t(std::strtoul(argv[++i], nullptr, 0));
+    } else if (!std::strcmp(argv[i], "-l") && i + 1 < argc) {
+      level = int32_t(std::strtol(argv[++i], nullptr, 0));
+    } else if (!std::strcmp(argv[i], "-o") && i + 1 < argc) {
+      output = argv[++i];
+    } else if (argv[i][0] == '-') {
+      usage();
+      return 1;
+    } else {
+      FileReader reader(argv[i], 32 * 1024, false);
+      if (!reader.isOpen()) {
+        std::fprintf(stderr, "Unable to open '%s'\n", argv[i]);
+        return 1;
+      }
+      std::vector<uint8_t>& sample = samples.emplace_back(reader.length());
+      reader.readUBytesToBuf(sample.data(), sample.size());
+      sampleBytes += sample.size();
+    }
+  }
+
+  if (!output || samples.empty()) {
+    usage();
+    return 1;
+  }
+
+  const std::vector<uint8_t> dictionary = Compression::trainZlibDictionary(samples, maxSize);
+  FileWriter writer(output, true, false);
+  if (!writer.isOpen()) {
+    std::fprintf(stderr, "Unable to create '%s'\n", output);
+    return 1;
+  }
+  writer.writeUBytes(dictionary.data(), dictionary.size());
+
+  Compression::ZlibContext ctx(level, Compression::ZlibContext::Format::Zlib);
+  const uint64_t plain = compressedSize(ctx, samples);
+  ctx.setDictionary(dictionary);
+  const uint64_t primed = compressedSize(ctx, samples);
+  std::printf("%zu samples, %llu bytes\n", samples.size(), static_cast<unsigned long long>(sampleBytes));
+  std::printf("%zu byte dictionary written to %s\n", dictionary.size(), output);
+  std::printf("level %d: %llu bytes without the dictionary, %llu bytes with it\n", level,
+              static_cast<unsigned long long>(plain), static_cast<unsigned long long>(primed));
+  return 0;
+}